@@ -12,8 +12,32 @@ HEADERS += \
     man/Concept.h \
     man/Model.h \
     man/Trait.h \
+    man/CacheLine.h \
+    man/RunnableState.h \
     man/Runnable.h \
+    man/TypedRunnable.h \
+    man/RunnablePolitic.h \
+    man/Future.h \
+    man/InjectionQueue.h \
+    man/Coroutine.h \
+    man/Algorithm.h \
+    man/TaskGraph.h \
     man/Chrono.h \
+    man/ClockPolitic.h \
+    man/WaitPolitic.h \
     man/RunnableQueue.h \
+    man/WorkStealingDeque.h \
+    man/Topology.h \
+    man/Metrics.h \
+    man/QueuePolitic.h \
+    man/RunnableStorage.h \
     man/copyable_atomic.h \
+    man/Cancellation.h \
+    man/IssueChannel.h \
+    man/ProgressAggregate.h \
+    man/TaskGroup.h \
+    man/ArenaContext.h \
+    man/Channel.h \
+    man/Pipeline.h \
+    man/TimerWheel.h \
     man/ThreadPool.h
@@ -0,0 +1,10 @@
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+CONFIG -= qt
+
+QMAKE_CXXFLAGS += /std:c++latest /permissive-
+
+INCLUDEPATH += ..
+
+SOURCES += main.cpp
@@ -0,0 +1,809 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <ctime>
+#include <deque>
+#include <future>
+#include <functional>
+#include "man/ThreadPool.h"
+
+/**
+ * Spinning and false sharing only show up when the submitters and the workers run on different cores
+ */
+void warnIfSingleCore() {
+    if(std::thread::hardware_concurrency() < 2) {
+        std::cout << "warning : only one core is available, this section can not show any gain" << std::endl;
+    }
+}
+
+namespace queueComparison {
+struct SpinTask {
+    void operator()() noexcept {
+        auto end = Clock::now() + m_duration;
+        while(Clock::now() < end);
+    }
+    std::chrono::nanoseconds m_duration;
+};
+
+/**
+ * Measure how many tasks per second a pool runs
+ */
+template<typename Pool>
+double tasksPerSecond(std::size_t numberOfThreads, std::size_t numberOfTasks,
+                      std::chrono::nanoseconds taskDuration) {
+    using namespace std::chrono;
+    Pool pool{numberOfThreads};
+
+    for(std::size_t i{0}; i < numberOfTasks; ++i) {
+        pool.addRunnable(SpinTask{nanoseconds{0}});
+        pool.wait();
+    }
+    pool.clear();
+
+    auto start = Clock::now();
+    for(std::size_t i{0}; i < numberOfTasks; ++i) {
+        pool.addRunnable(SpinTask{taskDuration});
+    }
+    pool.wait();
+    auto elapsed = duration_cast<duration<double>>(Clock::now() - start).count();
+
+    pool.clear();
+    return numberOfTasks / elapsed;
+}
+
+void run() {
+    using namespace std::chrono;
+    constexpr std::size_t numberOfTasks = 100000;
+    auto maxThreads = std::max<std::size_t>(std::thread::hardware_concurrency(), 2);
+
+    std::cout << std::setw(8) << "threads"
+              << std::setw(12) << "task (ns)"
+              << std::setw(16) << "mutex (t/s)"
+              << std::setw(16) << "stealing (t/s)" << std::endl;
+
+    for(auto duration : {nanoseconds{0}, nanoseconds{1000}}) {
+        for(std::size_t threads{1}; threads <= maxThreads; threads *= 2) {
+            auto mutex = tasksPerSecond<man::ThreadPool>(threads, numberOfTasks, duration);
+            auto stealing = tasksPerSecond<man::WorkStealingThreadPool>(threads, numberOfTasks, duration);
+            std::cout << std::setw(8) << threads
+                      << std::setw(12) << duration.count()
+                      << std::setw(16) << std::fixed << std::setprecision(0) << mutex
+                      << std::setw(16) << stealing << std::endl;
+        }
+    }
+}
+}
+
+namespace dispatchComparison {
+void run() {
+    using namespace std::chrono;
+    using queueComparison::SpinTask;
+    constexpr std::size_t numberOfTasks = 100000;
+
+    std::cout << std::setw(8) << "threads"
+              << std::setw(20) << "polymorphic (t/s)"
+              << std::setw(20) << "monomorphic (t/s)" << std::endl;
+
+    for(std::size_t threads{1}; threads <= 2; ++threads) {
+        auto polymorphic = queueComparison::tasksPerSecond<man::ThreadPool>(threads, numberOfTasks, nanoseconds{0});
+        auto monomorphic = queueComparison::tasksPerSecond<man::MonomorphicThreadPool<SpinTask>>(threads, numberOfTasks, nanoseconds{0});
+        std::cout << std::setw(8) << threads
+                  << std::setw(20) << std::fixed << std::setprecision(0) << polymorphic
+                  << std::setw(20) << monomorphic << std::endl;
+    }
+}
+}
+
+namespace clockComparison {
+template<typename ClockPolitic>
+using Pool = man::ThreadPoolWithContextsAndArgs<man::type_list<>, man::type_list<>, ClockPolitic>;
+
+void run() {
+    using namespace std::chrono;
+    constexpr std::size_t numberOfTasks = 100000;
+
+    std::cout << std::setw(8) << "threads"
+              << std::setw(16) << "steady (t/s)"
+              << std::setw(16) << "tsc (t/s)"
+              << std::setw(16) << "none (t/s)" << std::endl;
+
+    for(std::size_t threads{1}; threads <= 2; ++threads) {
+        auto steady = queueComparison::tasksPerSecond<Pool<man::steady_clock_politic>>(threads, numberOfTasks, nanoseconds{0});
+        auto tsc = queueComparison::tasksPerSecond<Pool<man::tsc_clock_politic>>(threads, numberOfTasks, nanoseconds{0});
+        auto none = queueComparison::tasksPerSecond<Pool<man::no_clock_politic>>(threads, numberOfTasks, nanoseconds{0});
+        std::cout << std::setw(8) << threads
+                  << std::setw(16) << std::fixed << std::setprecision(0) << steady
+                  << std::setw(16) << tsc
+                  << std::setw(16) << none << std::endl;
+    }
+}
+}
+
+namespace waitComparison {
+template<typename WaitPolitic>
+using Pool = man::ThreadPoolWithContextsAndArgs<man::type_list<>, man::type_list<>,
+                                                man::work_stealing_queue_politic, WaitPolitic>;
+
+struct StartTime {
+    void operator()() noexcept {
+        *m_start = Clock::now();
+    }
+    Clock::time_point *m_start;
+};
+
+double cpuSeconds() {
+    return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+}
+
+/**
+ * Measure :
+ *  - the number of cores burnt by an idle pool
+ *  - the latency between the submission and the start of a task when the pool was idle
+ *  - the latency and the cpu time of a submission followed by a wait
+ */
+template<typename WaitPolitic>
+void measure(const char *name, std::size_t numberOfThreads) {
+    using namespace std::chrono;
+    constexpr std::size_t numberOfSamples = 200;
+    constexpr std::size_t numberOfRoundTrips = 20000;
+    Pool<WaitPolitic> pool{numberOfThreads};
+
+    auto idleDuration = milliseconds{200};
+    auto cpuStart = cpuSeconds();
+    std::this_thread::sleep_for(idleDuration);
+    auto idleCores = (cpuSeconds() - cpuStart) / duration_cast<duration<double>>(idleDuration).count();
+
+    nanoseconds wakeUpLatency{0};
+    for(std::size_t i{0}; i < numberOfSamples; ++i) {
+        std::this_thread::sleep_for(milliseconds{1});
+        Clock::time_point start;
+        auto submission = Clock::now();
+        pool.addRunnable(StartTime{&start})->template waitUntilFinished<WaitPolitic>();
+        wakeUpLatency += duration_cast<nanoseconds>(start - submission);
+    }
+    pool.clear();
+
+    cpuStart = cpuSeconds();
+    auto start = Clock::now();
+    Clock::time_point ignored;
+    for(std::size_t i{0}; i < numberOfRoundTrips; ++i) {
+        pool.addRunnableAndForget(StartTime{&ignored});
+        pool.wait();
+    }
+    auto roundTrip = duration_cast<nanoseconds>(Clock::now() - start) / numberOfRoundTrips;
+    auto roundTripCpu = (cpuSeconds() - cpuStart) * 1e9 / numberOfRoundTrips;
+
+    std::cout << std::setw(14) << name
+              << std::setw(14) << std::fixed << std::setprecision(2) << idleCores
+              << std::setw(14) << (wakeUpLatency / numberOfSamples).count()
+              << std::setw(16) << roundTrip.count()
+              << std::setw(16) << std::setprecision(0) << roundTripCpu << std::endl;
+}
+
+void run() {
+    auto numberOfThreads = std::max<std::size_t>(std::thread::hardware_concurrency(), 2);
+    warnIfSingleCore();
+
+    std::cout << std::setw(14) << "politic"
+              << std::setw(14) << "idle cores"
+              << std::setw(14) << "wake (ns)"
+              << std::setw(16) << "round trip (ns)"
+              << std::setw(16) << "trip cpu (ns)" << std::endl;
+
+    measure<man::yield_wait_politic>("yield", numberOfThreads);
+    measure<man::adaptive_wait_politic<>>("adaptive", numberOfThreads);
+    measure<man::park_wait_politic>("park", numberOfThreads);
+}
+}
+
+namespace bulkComparison {
+/**
+ * Measure the time to submit a batch and to run it, one by one or with one bulk submission
+ */
+template<typename Pool>
+void measure(const char *name, std::size_t numberOfThreads, std::size_t batchSize) {
+    using namespace std::chrono;
+    using queueComparison::SpinTask;
+    Pool pool{numberOfThreads};
+    std::vector<SpinTask> batch(batchSize, SpinTask{nanoseconds{0}});
+
+    // The slots of the storage are created once, so both ways recycle them
+    pool.addRunnablesAndForget(batch);
+    pool.wait();
+
+    auto start = Clock::now();
+    for(auto &task : batch) {
+        pool.addRunnableAndForget(task);
+    }
+    auto loopSubmission = duration_cast<microseconds>(Clock::now() - start);
+    pool.wait();
+    auto loopTotal = duration_cast<microseconds>(Clock::now() - start);
+
+    start = Clock::now();
+    pool.addRunnablesAndForget(batch);
+    auto bulkSubmission = duration_cast<microseconds>(Clock::now() - start);
+    pool.wait();
+    auto bulkTotal = duration_cast<microseconds>(Clock::now() - start);
+
+    std::cout << std::setw(10) << name
+              << std::setw(8) << numberOfThreads
+              << std::setw(18) << loopSubmission.count()
+              << std::setw(14) << loopTotal.count()
+              << std::setw(18) << bulkSubmission.count()
+              << std::setw(14) << bulkTotal.count() << std::endl;
+}
+
+void run() {
+    constexpr std::size_t batchSize = 10000;
+    auto maxThreads = std::max<std::size_t>(std::thread::hardware_concurrency(), 2);
+
+    std::cout << std::setw(10) << "queue"
+              << std::setw(8) << "threads"
+              << std::setw(18) << "loop submit (us)"
+              << std::setw(14) << "loop (us)"
+              << std::setw(18) << "bulk submit (us)"
+              << std::setw(14) << "bulk (us)" << std::endl;
+
+    for(std::size_t threads{1}; threads <= maxThreads; threads *= 2) {
+        measure<man::ThreadPool>("mutex", threads, batchSize);
+        measure<man::WorkStealingThreadPool>("stealing", threads, batchSize);
+    }
+}
+}
+
+namespace contentionComparison {
+struct Increment {
+    int operator()(int value) noexcept {
+        return value + 1;
+    }
+};
+
+/**
+ * Measure how many tiny tasks per second are run while several threads submit them
+ * and wait for each of them, so submitters and workers touch neighbour runnables
+ */
+template<typename Pool>
+double tasksPerSecond(std::size_t numberOfThreads, std::size_t numberOfSubmitters) {
+    using namespace std::chrono;
+    constexpr std::size_t numberOfTasks = 20000;
+    constexpr std::size_t batchSize = 64;
+    Pool pool{numberOfThreads};
+    auto start = Clock::now();
+
+    std::vector<std::thread> submitters;
+    for(std::size_t submitter{0}; submitter < numberOfSubmitters; ++submitter) {
+        submitters.emplace_back([&pool] {
+            for(std::size_t batch{0}; batch < numberOfTasks / batchSize; ++batch) {
+                std::vector<decltype(pool.addRunnable(Increment{}, 0))> futures;
+                for(std::size_t i{0}; i < batchSize; ++i) {
+                    futures.push_back(pool.addRunnable(Increment{}, static_cast<int>(i)));
+                }
+
+                for(auto &future : futures) {
+                    future.wait();
+                }
+            }
+        });
+    }
+
+    for(auto &submitter : submitters) {
+        submitter.join();
+    }
+
+    auto elapsed = duration_cast<duration<double>>(Clock::now() - start).count();
+    pool.clear();
+    return static_cast<double>(numberOfTasks * numberOfSubmitters) / elapsed;
+}
+
+void run() {
+    auto maxThreads = std::max<std::size_t>(std::thread::hardware_concurrency(), 2);
+    warnIfSingleCore();
+
+    std::cout << std::setw(8) << "threads"
+              << std::setw(12) << "submitters"
+              << std::setw(16) << "mutex (t/s)"
+              << std::setw(16) << "stealing (t/s)" << std::endl;
+
+    for(std::size_t submitters{1}; submitters <= 4; submitters *= 2) {
+        auto mutex = tasksPerSecond<man::ThreadPoolWithArgs<int>>(maxThreads, submitters);
+        auto stealing = tasksPerSecond<man::ThreadPoolWithContextsAndArgs<man::type_list<>, man::type_list<int>,
+                                                                          man::work_stealing_queue_politic>>(maxThreads, submitters);
+        std::cout << std::setw(8) << maxThreads
+                  << std::setw(12) << submitters
+                  << std::setw(16) << std::fixed << std::setprecision(0) << mutex
+                  << std::setw(16) << stealing << std::endl;
+    }
+}
+}
+
+namespace priorityComparison {
+/**
+ * Measure the latency between the submission and the start of interactive runnables
+ * while the pool is saturated by background ones
+ */
+template<typename Pool, bool hasPriorities>
+void measure(const char *name, std::size_t numberOfThreads) {
+    using namespace std::chrono;
+    constexpr std::size_t numberOfBackgroundTasks = 20000;
+    constexpr std::size_t numberOfSamples = 100;
+    Pool pool{numberOfThreads};
+
+    for(std::size_t i{0}; i < numberOfBackgroundTasks; ++i) {
+        if constexpr(hasPriorities) {
+            pool.addRunnableAndForget(man::Priority::BACKGROUND, queueComparison::SpinTask{microseconds{10}});
+        }
+
+        else {
+            pool.addRunnableAndForget(queueComparison::SpinTask{microseconds{10}});
+        }
+    }
+
+    std::vector<Clock::time_point> starts(numberOfSamples);
+    std::vector<nanoseconds> latencies;
+    for(std::size_t i{0}; i < numberOfSamples; ++i) {
+        auto submission = Clock::now();
+        waitComparison::StartTime task{&starts[i]};
+
+        if constexpr(hasPriorities) {
+            pool.addRunnable(man::Priority::INTERACTIVE, task).wait();
+        }
+
+        else {
+            pool.addRunnable(task).wait();
+        }
+
+        latencies.push_back(duration_cast<nanoseconds>(starts[i] - submission));
+    }
+    pool.wait();
+    pool.clear();
+
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << std::setw(10) << name
+              << std::setw(16) << duration_cast<microseconds>(latencies[numberOfSamples / 2]).count()
+              << std::setw(16) << duration_cast<microseconds>(latencies[numberOfSamples * 99 / 100]).count() << std::endl;
+}
+
+void run() {
+    auto numberOfThreads = std::max<std::size_t>(std::thread::hardware_concurrency(), 2);
+    warnIfSingleCore();
+
+    std::cout << std::setw(10) << "queue"
+              << std::setw(16) << "p50 (us)"
+              << std::setw(16) << "p99 (us)" << std::endl;
+
+    measure<man::ThreadPool, false>("mutex", numberOfThreads);
+    measure<man::WorkStealingThreadPool, false>("stealing", numberOfThreads);
+    measure<man::ThreadPoolWithContextsAndArgs<man::type_list<>, man::type_list<>,
+                                               man::priority_queue_politic<>>, true>("priority", numberOfThreads);
+}
+}
+
+/**
+ * Results of the suite, written as CSV or JSON to compare two versions of the pool
+ */
+class Report {
+public:
+    struct Result {
+        std::string benchmark;
+        std::string executor;
+        std::size_t threads;
+        std::string metric;
+        double value;
+    };
+
+    void add(std::string benchmark, std::string executor, std::size_t threads, std::string metric, double value) {
+        std::cout << std::setw(12) << benchmark
+                  << std::setw(10) << executor
+                  << std::setw(8) << threads
+                  << std::setw(22) << metric
+                  << std::setw(16) << std::fixed << std::setprecision(1) << value << std::endl;
+        m_results.push_back(Result{std::move(benchmark), std::move(executor), threads, std::move(metric), value});
+    }
+
+    void writeCsv(std::ostream &stream) const {
+        stream << "benchmark,executor,threads,metric,value\n";
+        for(auto &result : m_results) {
+            stream << result.benchmark << ',' << result.executor << ',' << result.threads << ','
+                   << result.metric << ',' << result.value << '\n';
+        }
+    }
+
+    void writeJson(std::ostream &stream) const {
+        stream << "[\n";
+        for(std::size_t i{0}; i < m_results.size(); ++i) {
+            auto &result = m_results[i];
+            stream << "  {\"benchmark\": \"" << result.benchmark << "\", \"executor\": \"" << result.executor
+                   << "\", \"threads\": " << result.threads << ", \"metric\": \"" << result.metric
+                   << "\", \"value\": " << result.value << (i + 1 < m_results.size() ? "},\n" : "}\n");
+        }
+        stream << "]\n";
+    }
+
+private:
+    std::vector<Result> m_results;
+};
+
+namespace baselines {
+/**
+ * The pools of the library seen through the interface shared with the baselines
+ */
+template<typename Pool>
+class PoolExecutor {
+public:
+    explicit PoolExecutor(std::size_t numberOfThreads) : m_pool{numberOfThreads} {}
+
+    template<typename F>
+    void submit(F &&f) {
+        m_pool.addRunnableAndForget(std::forward<F>(f));
+    }
+
+    void wait() noexcept {
+        m_pool.wait();
+    }
+
+private:
+    Pool m_pool;
+};
+
+/**
+ * The usual first thread pool : one std::function queue behind one mutex
+ */
+class NaiveThreadPool {
+public:
+    explicit NaiveThreadPool(std::size_t numberOfThreads) {
+        for(std::size_t i{0}; i < numberOfThreads; ++i) {
+            m_threads.emplace_back([this] {run();});
+        }
+    }
+
+    ~NaiveThreadPool() {
+        {
+            std::scoped_lock lock{m_mutex};
+            m_done = true;
+        }
+        m_hasTasks.notify_all();
+
+        for(auto &thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    template<typename F>
+    void submit(F &&f) {
+        {
+            std::scoped_lock lock{m_mutex};
+            m_tasks.emplace_back(std::forward<F>(f));
+            m_numberOfPendingTasks++;
+        }
+        m_hasTasks.notify_one();
+    }
+
+    void wait() {
+        std::unique_lock lock{m_mutex};
+        m_isFinished.wait(lock, [this] {return m_numberOfPendingTasks == 0;});
+    }
+
+private:
+    void run() {
+        std::unique_lock lock{m_mutex};
+
+        while(true) {
+            m_hasTasks.wait(lock, [this] {return m_done || !m_tasks.empty();});
+
+            if(m_tasks.empty()) {
+                return;
+            }
+
+            auto task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+
+            if(--m_numberOfPendingTasks == 0) {
+                m_isFinished.notify_all();
+            }
+        }
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_hasTasks;
+    std::condition_variable m_isFinished;
+    std::deque<std::function<void()>> m_tasks;
+    std::size_t m_numberOfPendingTasks{0};
+    bool m_done{false};
+    std::vector<std::thread> m_threads;
+};
+
+/**
+ * One std::async by task : the number of threads is not bounded
+ */
+class AsyncExecutor {
+public:
+    explicit AsyncExecutor(std::size_t) noexcept {}
+
+    template<typename F>
+    void submit(F &&f) {
+        auto future = std::async(std::launch::async, std::forward<F>(f));
+        std::scoped_lock lock{m_mutex};
+        m_futures.push_back(std::move(future));
+    }
+
+    void wait() {
+        // The tasks may submit other tasks while they are waited for
+        while(true) {
+            std::vector<std::future<void>> futures;
+            {
+                std::scoped_lock lock{m_mutex};
+                futures.swap(m_futures);
+            }
+
+            if(futures.empty()) {
+                return;
+            }
+
+            for(auto &future : futures) {
+                future.get();
+            }
+        }
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<std::future<void>> m_futures;
+};
+}
+
+namespace suite {
+using namespace std::chrono;
+
+double percentile(std::vector<nanoseconds> &samples, double ratio) {
+    std::sort(samples.begin(), samples.end());
+    auto index = static_cast<std::size_t>(ratio * static_cast<double>(samples.size() - 1));
+    return static_cast<double>(samples[index].count());
+}
+
+double secondsSince(Clock::time_point start) {
+    return duration_cast<duration<double>>(Clock::now() - start).count();
+}
+
+void spin(nanoseconds duration) noexcept {
+    auto end = Clock::now() + duration;
+    while(Clock::now() < end);
+}
+
+/**
+ * Submit batches of empty tasks and measure the cost of each submission,
+ * and the time between the submission and the end of each task
+ */
+template<typename Executor>
+void latency(Report &report, const char *name, std::size_t numberOfThreads, std::size_t batchSize) {
+    constexpr std::size_t numberOfBatches = 10;
+    Executor executor{numberOfThreads};
+    std::vector<nanoseconds> submitLatencies;
+    std::vector<nanoseconds> taskLatencies;
+    std::vector<Clock::time_point> ends(batchSize);
+    std::vector<Clock::time_point> submissions(batchSize);
+
+    for(std::size_t batch{0}; batch < numberOfBatches; ++batch) {
+        for(std::size_t i{0}; i < batchSize; ++i) {
+            submissions[i] = Clock::now();
+            executor.submit([end = &ends[i]]() noexcept {*end = Clock::now();});
+            submitLatencies.push_back(duration_cast<nanoseconds>(Clock::now() - submissions[i]));
+        }
+        executor.wait();
+
+        for(std::size_t i{0}; i < batchSize; ++i) {
+            taskLatencies.push_back(duration_cast<nanoseconds>(ends[i] - submissions[i]));
+        }
+    }
+
+    report.add("latency", name, numberOfThreads, "submit p50 (ns)", percentile(submitLatencies, 0.5));
+    report.add("latency", name, numberOfThreads, "submit p99 (ns)", percentile(submitLatencies, 0.99));
+    report.add("latency", name, numberOfThreads, "task p50 (ns)", percentile(taskLatencies, 0.5));
+    report.add("latency", name, numberOfThreads, "task p99 (ns)", percentile(taskLatencies, 0.99));
+    report.add("latency", name, numberOfThreads, "task p999 (ns)", percentile(taskLatencies, 0.999));
+}
+
+template<typename Executor>
+double emptyTasksPerSecond(std::size_t numberOfThreads, std::size_t numberOfTasks) {
+    Executor executor{numberOfThreads};
+    auto start = Clock::now();
+
+    for(std::size_t i{0}; i < numberOfTasks; ++i) {
+        executor.submit([]() noexcept {});
+    }
+    executor.wait();
+
+    return static_cast<double>(numberOfTasks) / secondsSince(start);
+}
+
+/**
+ * Rounds of fanOut tasks of 10us, each round waits for all its tasks
+ */
+template<typename Executor>
+void fanOutFanIn(Report &report, const char *name, std::size_t numberOfThreads, std::size_t fanOut) {
+    constexpr std::size_t numberOfRounds = 50;
+    Executor executor{numberOfThreads};
+    auto start = Clock::now();
+
+    for(std::size_t round{0}; round < numberOfRounds; ++round) {
+        for(std::size_t i{0}; i < fanOut; ++i) {
+            executor.submit([]() noexcept {spin(microseconds{10});});
+        }
+        executor.wait();
+    }
+
+    report.add("fan-out", name, numberOfThreads, "round (us)", secondsSince(start) * 1e6 / numberOfRounds);
+}
+
+/**
+ * Recursive fork : each call to fib(n) forks fib(n - 1) and fib(n - 2),
+ * the leaves add their value, and the root joins the whole tree
+ */
+template<typename Executor>
+struct Fib {
+    void operator()() const noexcept {
+        if(m_n < 2) {
+            m_sum->fetch_add(m_n, std::memory_order_relaxed);
+            return;
+        }
+
+        m_executor->submit(Fib{m_executor, m_sum, m_n - 1});
+        m_executor->submit(Fib{m_executor, m_sum, m_n - 2});
+    }
+
+    Executor *m_executor;
+    std::atomic<std::size_t> *m_sum;
+    std::size_t m_n;
+};
+
+std::size_t serialFib(std::size_t n) noexcept {
+    return n < 2 ? n : serialFib(n - 1) + serialFib(n - 2);
+}
+
+template<typename Executor>
+void forkJoin(Report &report, const char *name, std::size_t numberOfThreads, std::size_t n) {
+    Executor executor{numberOfThreads};
+    std::atomic<std::size_t> sum{0};
+    auto start = Clock::now();
+
+    executor.submit(Fib<Executor>{&executor, &sum, n});
+    executor.wait();
+
+    auto elapsed = secondsSince(start);
+    assert(sum.load() == serialFib(n));
+    report.add("fib", name, numberOfThreads, "fib(" + std::to_string(n) + ") (ms)", elapsed * 1e3);
+}
+
+/**
+ * One task out of 16 lasts 100 times longer than the other ones
+ */
+template<typename Executor>
+void skewed(Report &report, const char *name, std::size_t numberOfThreads) {
+    constexpr std::size_t numberOfTasks = 2048;
+    Executor executor{numberOfThreads};
+    auto start = Clock::now();
+
+    for(std::size_t i{0}; i < numberOfTasks; ++i) {
+        auto duration = i % 16 == 0 ? microseconds{200} : microseconds{2};
+        executor.submit([duration]() noexcept {spin(duration);});
+    }
+    executor.wait();
+
+    report.add("skewed", name, numberOfThreads, "total (ms)", secondsSince(start) * 1e3);
+}
+
+template<typename Executor>
+void runAll(Report &report, const char *name, std::size_t numberOfThreads, bool isAsync) {
+    // std::async creates one thread by task, so it gets smaller workloads
+    latency<Executor>(report, name, numberOfThreads, isAsync ? 100 : 1000);
+    report.add("throughput", name, numberOfThreads, "empty tasks (t/s)",
+               emptyTasksPerSecond<Executor>(numberOfThreads, isAsync ? 2000 : 100000));
+    fanOutFanIn<Executor>(report, name, numberOfThreads, 64);
+    forkJoin<Executor>(report, name, numberOfThreads, isAsync ? 12 : 20);
+    skewed<Executor>(report, name, numberOfThreads);
+}
+
+void run(Report &report) {
+    using namespace baselines;
+    auto maxThreads = std::max<std::size_t>(std::thread::hardware_concurrency(), 2);
+
+    std::cout << std::setw(12) << "benchmark"
+              << std::setw(10) << "executor"
+              << std::setw(8) << "threads"
+              << std::setw(22) << "metric"
+              << std::setw(16) << "value" << std::endl;
+
+    runAll<PoolExecutor<man::ThreadPool>>(report, "mutex", maxThreads, false);
+    runAll<PoolExecutor<man::WorkStealingThreadPool>>(report, "stealing", maxThreads, false);
+    runAll<NaiveThreadPool>(report, "naive", maxThreads, false);
+    runAll<AsyncExecutor>(report, "async", maxThreads, true);
+
+    for(std::size_t threads{1}; threads <= maxThreads; threads *= 2) {
+        report.add("scaling", "mutex", threads, "empty tasks (t/s)",
+                   emptyTasksPerSecond<PoolExecutor<man::ThreadPool>>(threads, 100000));
+        report.add("scaling", "stealing", threads, "empty tasks (t/s)",
+                   emptyTasksPerSecond<PoolExecutor<man::WorkStealingThreadPool>>(threads, 100000));
+        report.add("scaling", "naive", threads, "empty tasks (t/s)",
+                   emptyTasksPerSecond<NaiveThreadPool>(threads, 100000));
+        fanOutFanIn<PoolExecutor<man::ThreadPool>>(report, "mutex", threads, 64);
+        fanOutFanIn<PoolExecutor<man::WorkStealingThreadPool>>(report, "stealing", threads, 64);
+        fanOutFanIn<NaiveThreadPool>(report, "naive", threads, 64);
+    }
+}
+}
+
+/**
+ * benchmark [sections...] [--csv file] [--json file]
+ *
+ * Without any section, all of them are run. Only the suite is written to the files.
+ */
+int main(int argc, char **argv) {
+    std::vector<std::string> sections;
+    std::string csvPath;
+    std::string jsonPath;
+
+    for(int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+
+        if((argument == "--csv" || argument == "--json") && i + 1 < argc) {
+            (argument == "--csv" ? csvPath : jsonPath) = argv[++i];
+        }
+
+        else {
+            sections.push_back(argument);
+        }
+    }
+
+    auto mustRun = [&sections](const std::string &section) {
+        return sections.empty() || std::find(sections.begin(), sections.end(), section) != sections.end();
+    };
+
+    if(mustRun("queue")) {
+        std::cout << "==QUEUE COMPARISON==" << std::endl;
+        queueComparison::run();
+    }
+    if(mustRun("dispatch")) {
+        std::cout << "==DISPATCH COMPARISON==" << std::endl;
+        dispatchComparison::run();
+    }
+    if(mustRun("clock")) {
+        std::cout << "==CLOCK COMPARISON==" << std::endl;
+        clockComparison::run();
+    }
+    if(mustRun("wait")) {
+        std::cout << "==WAIT COMPARISON==" << std::endl;
+        waitComparison::run();
+    }
+    if(mustRun("bulk")) {
+        std::cout << "==BULK COMPARISON==" << std::endl;
+        bulkComparison::run();
+    }
+    if(mustRun("contention")) {
+        std::cout << "==CONTENTION COMPARISON==" << std::endl;
+        contentionComparison::run();
+    }
+    if(mustRun("priority")) {
+        std::cout << "==PRIORITY COMPARISON==" << std::endl;
+        priorityComparison::run();
+    }
+
+    Report report;
+    if(mustRun("suite")) {
+        std::cout << "==SUITE==" << std::endl;
+        suite::run(report);
+    }
+
+    if(!csvPath.empty()) {
+        std::ofstream file{csvPath};
+        report.writeCsv(file);
+    }
+    if(!jsonPath.empty()) {
+        std::ofstream file{jsonPath};
+        report.writeJson(file);
+    }
+    return 0;
+}
@@ -1,5 +1,14 @@
 #include <iostream>
+#include <array>
+#include <stdexcept>
+#include <numeric>
 #include "man/ThreadPool.h"
+#include "man/Algorithm.h"
+#include "man/TaskGraph.h"
+#include "man/ProgressAggregate.h"
+#include "man/TaskGroup.h"
+#include "man/ArenaContext.h"
+#include "man/Pipeline.h"
 
 man::ThreadPool pool{};
 
@@ -119,6 +128,1212 @@ void test() {
 }
 }
 
+namespace testWorkStealing {
+struct Test {
+    int operator()(int a) noexcept {
+        m_counter->fetch_add(1, std::memory_order_relaxed);
+        return a * 2;
+    }
+    std::atomic<int> *m_counter;
+};
+
+void test() {
+    std::atomic<int> counter{0};
+    man::ThreadPoolWithContextsAndArgs<man::type_list<>, man::type_list<int>, man::work_stealing_queue_politic>
+            poolStealing{4};
+
+    std::vector<man::Future<int, man::Runnable<int>>> runnables;
+    for(int i = 0; i < 1000; ++i) {
+        runnables.emplace_back(poolStealing.addRunnable(Test{&counter}, i));
+    }
+
+    poolStealing.wait();
+
+    for(int i = 0; i < 1000; ++i) {
+        assert(runnables[i]->getResult<int>() == i * 2);
+    }
+
+    assert(counter == 1000);
+}
+}
+
+namespace testForget {
+struct Test {
+    void operator()() noexcept {
+        m_counter->fetch_add(1, std::memory_order_relaxed);
+    }
+    std::atomic<int> *m_counter;
+};
+
+void test() {
+    std::atomic<int> counter{0};
+
+    for(int i = 0; i < 10; ++i) {
+        for(int j = 0; j < 1000; ++j) {
+            pool.addRunnableAndForget(Test{&counter});
+        }
+        pool.wait();
+    }
+
+    assert(counter == 10 * 1000);
+
+    // The slots of the released runnables are recycled
+    man::RunnableStorage<int> storage;
+    for(int i = 0; i < 1000; ++i) {
+        auto value = storage.emplaceDetached(i);
+        assert(*value == i);
+        storage.releaseIfDetached(value);
+    }
+    assert(storage.capacity() == 1);
+
+    auto attached = storage.emplace(42);
+    storage.releaseIfDetached(attached);
+    assert(*attached == 42);
+
+    // Neighbour runnables never share a cache line
+    auto neighbour = storage.emplace(43);
+    auto distance = reinterpret_cast<std::uintptr_t>(neighbour) - reinterpret_cast<std::uintptr_t>(attached);
+    assert(distance % man::cacheLineSize == 0 && distance >= man::cacheLineSize);
+    storage.clear();
+}
+}
+
+namespace testInline {
+struct Small {
+    int operator()() noexcept {return 42;}
+};
+
+struct Large {
+    int operator()() noexcept {return m_values[0];}
+    std::array<int, 64> m_values{42};
+};
+
+void test() {
+    auto numberOfSpilled = man::getNumberOfSpilledRunnables();
+    auto small = pool.addRunnable(Small{});
+    assert(man::getNumberOfSpilledRunnables() == numberOfSpilled);
+    auto large = pool.addRunnable(Large{});
+    assert(man::getNumberOfSpilledRunnables() == numberOfSpilled + 1);
+    pool.wait();
+    assert(small->getResult<int>() == 42);
+    assert(large->getResult<int>() == 42);
+
+    // The task must survive a move of the runnable
+    man::Runnable<> runnable{Small{}};
+    man::Runnable<> moved{std::move(runnable)};
+    moved.launch();
+    assert(moved.getResult<int>() == 42);
+}
+}
+
+namespace testMonomorphic {
+void test() {
+    man::MonomorphicThreadPoolWithArgs<testArgs::Test, int, int> poolArgs{2};
+    std::vector<man::Future<int, man::TypedRunnable<testArgs::Test, int, int>>> runnables;
+
+    for(int i = 0; i < 100; ++i) {
+        runnables.emplace_back(poolArgs.addRunnable(testArgs::Test{}, i, 42));
+    }
+
+    poolArgs.wait();
+
+    for(int i = 0; i < 100; ++i) {
+        assert(runnables[i].get() == i + 42);
+    }
+
+    // The getProgression and getIssues hooks of the task are still used
+    man::MonomorphicThreadPool<testIssue::Test> poolIssue{1};
+    auto runnable = poolIssue.addRunnable(testIssue::Test{});
+    poolIssue.wait();
+    auto [message, code] = getIssues(*runnable)[0];
+    assert(message == "Nothing");
+    assert(code == man::KindOfError::INFORMATION);
+    assert(*getProgression(*runnable) == 1.0f);
+}
+}
+
+namespace testFuture {
+int return21() noexcept {
+    return 21;
+}
+
+void test() {
+    std::atomic<int> numberOfVoidContinuations{0};
+    auto future = pool.addRunnable(return21);
+    auto doubled = future.then([](int &value) noexcept {return value * 2;});
+    auto text = doubled.then([](int &value) noexcept {return std::to_string(value);});
+    auto last = text.then([&numberOfVoidContinuations](std::string &) noexcept {
+        numberOfVoidContinuations++;
+    });
+
+    pool.wait();
+    assert(future.get() == 21);
+    assert(doubled.get() == 42);
+    assert(text.get() == "42");
+    last.wait();
+    assert(numberOfVoidContinuations == 1);
+
+    // The continuation of a finished runnable is launched at once
+    auto late = future.then([](int &value) noexcept {return value + 1;});
+    assert(late.isReady());
+    assert(late.get() == 22);
+
+    // The continuations of a runnable are launched in the order they were added
+    std::atomic<bool> isBlocked{true};
+    std::vector<int> order;
+    auto blocked = pool.addRunnable([&isBlocked]() noexcept {
+        while(isBlocked) {
+            std::this_thread::yield();
+        }
+    });
+    auto firstContinuation = blocked.then([&order]() noexcept {order.push_back(1);});
+    auto secondContinuation = blocked.then([&order]() noexcept {order.push_back(2);});
+    isBlocked = false;
+    secondContinuation.wait();
+    assert(firstContinuation.isReady() && (order == std::vector<int>{1, 2}));
+
+    // get does not move the result out while a continuation reads it
+    isBlocked = true;
+    auto letters = pool.addRunnable([&isBlocked]() noexcept {
+        while(isBlocked) {
+            std::this_thread::yield();
+        }
+        return std::string(1000, 'a');
+    });
+    auto size = letters.then([](std::string &value) noexcept {
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+        return value.size();
+    });
+    std::string result;
+    std::thread getter{[&letters, &result] {result = letters.get();}};
+    isBlocked = false;
+    getter.join();
+    assert(size.isReady() && size.get() == 1000 && result.size() == 1000);
+    pool.clear();
+}
+}
+
+namespace testTaskHandle {
+std::atomic<int> numberOfMoves{0};
+
+// Neither default constructible nor copyable
+struct Buffer {
+    explicit Buffer(int value) : m_values(1000, value) {}
+    Buffer(Buffer &&other) noexcept : m_values{std::move(other.m_values)} {numberOfMoves++;}
+    Buffer(const Buffer &) = delete;
+    std::vector<int> m_values;
+};
+
+struct MakeBuffer {
+    Buffer operator()() noexcept {
+        return Buffer{42};
+    }
+};
+
+template<typename Pool>
+void test() {
+    Pool pool{2};
+    numberOfMoves = 0;
+    man::TaskHandle<Buffer, man::Runnable<>> handle = pool.addRunnable(MakeBuffer{});
+
+    // The result is constructed in place
+    Buffer &inPlace = handle.getReference();
+    assert(inPlace.m_values[999] == 42);
+    assert(numberOfMoves == 0);
+
+    Buffer moved = handle.get();
+    assert(moved.m_values[0] == 42);
+    assert(numberOfMoves == 1);
+    pool.clear();
+}
+
+void test() {
+    test<man::ThreadPool>();
+
+    // The typed runnable carries neither a vptr nor the type index of the result
+    static_assert(!std::is_polymorphic_v<man::TypedRunnable<MakeBuffer>>);
+
+    man::MonomorphicThreadPool<MakeBuffer> monomorphicPool{2};
+    auto handle = monomorphicPool.addRunnable(MakeBuffer{});
+    assert(handle.getReference().m_values[0] == 42);
+    monomorphicPool.clear();
+}
+}
+
+namespace testBulk {
+struct Square {
+    int operator()(int offset) noexcept {
+        return value * value + offset;
+    }
+
+    int value;
+};
+
+template<typename Pool>
+void test(Pool &&bulkPool) {
+    std::vector<Square> squares;
+    for(int i = 0; i < 10000; ++i) {
+        squares.push_back(Square{i});
+    }
+
+    auto futures = bulkPool.addRunnables(squares, 1);
+    assert(futures.size() == squares.size());
+
+    std::atomic<int> numberOfForgotten{0};
+    auto count = [&numberOfForgotten](int offset) noexcept {
+        numberOfForgotten += offset;
+    };
+    std::array<decltype(count), 3> forgotten{count, count, count};
+    bulkPool.addRunnablesAndForget(forgotten.begin(), forgotten.end(), 2);
+
+    auto empty = bulkPool.addRunnables(squares.end(), squares.end(), 0);
+    assert(empty.empty());
+
+    bulkPool.wait();
+    for(int i = 0; i < 10000; ++i) {
+        assert(futures[i].get() == i * i + 1);
+    }
+    assert(numberOfForgotten == 6);
+    bulkPool.clear();
+}
+
+void test() {
+    test(man::ThreadPoolWithArgs<int>{3});
+    test(man::ThreadPoolWithContextsAndArgs<man::type_list<>, man::type_list<int>,
+                                            man::work_stealing_queue_politic>{3});
+}
+}
+
+namespace testAlgorithm {
+void test() {
+    std::vector<long> counters(4, 0);
+    std::atomic<std::size_t> numberOfCounters{0};
+    man::ThreadPoolWithContext<long*> poolCounter{4, [&] {
+        return &counters[numberOfCounters++];
+    }};
+
+    // Skewed workload : the last elements are much more expensive
+    std::atomic<long> sum{0};
+    man::parallel_for(poolCounter, 0, 10000, [&sum](long *counter, int i) noexcept {
+        auto cost = i > 9900 ? 10000 : 1;
+        long value = 0;
+        for(int j = 0; j < cost; ++j) {
+            value += j % 3;
+        }
+        sum += i + value - value;
+        ++*counter;
+    });
+    assert(sum == 10000l * 9999 / 2);
+    assert(std::accumulate(counters.begin(), counters.end(), 0l) == 10000);
+
+    std::vector<int> values(12345);
+    std::iota(values.begin(), values.end(), 1);
+    auto total = man::parallel_reduce(poolCounter, values.begin(), values.end(), 0l,
+                                      [](long a, long b) noexcept {return a + b;}, 16);
+    assert(total == 12345l * 12346 / 2);
+    assert(man::parallel_reduce(poolCounter, values.end(), values.end(), 7l, std::plus<>{}) == 7);
+
+    std::vector<int> squares(values.size());
+    auto end = man::parallel_transform(poolCounter, values.cbegin(), values.cend(), squares.begin(),
+                                       [](long *, int value) noexcept {return value * 2;});
+    assert(end == squares.end());
+    for(std::size_t i = 0; i < values.size(); ++i) {
+        assert(squares[i] == values[i] * 2);
+    }
+}
+}
+
+namespace testTaskGraph {
+struct Step {
+    int operator()() noexcept {
+        return (*m_clock)++;
+    }
+
+    std::atomic<int> *m_clock;
+};
+
+void test() {
+    std::atomic<int> clock{0};
+    man::TaskGraph<> graph;
+
+    // A root, 100 fully connected layers of 4 nodes, then a sink
+    auto first = graph.addNode(Step{&clock});
+    std::vector<std::size_t> previousLayer{first};
+    for(int layer = 0; layer < 100; ++layer) {
+        std::vector<std::size_t> currentLayer;
+        for(int i = 0; i < 4; ++i) {
+            auto node = graph.addNode(Step{&clock});
+            for(auto previous : previousLayer) {
+                graph.addEdge(previous, node);
+            }
+            currentLayer.push_back(node);
+        }
+        previousLayer = currentLayer;
+    }
+    auto last = graph.addNode(Step{&clock});
+    for(auto previous : previousLayer) {
+        graph.addEdge(previous, last);
+    }
+
+    // The graph is run twice without being rebuilt
+    for(int run = 0; run < 2; ++run) {
+        graph.run(pool);
+        graph.wait();
+        assert(!graph.isRunning());
+        assert(graph[first].getResult<int>() == run * 402);
+        assert(graph[last].getResult<int>() == run * 402 + 401);
+
+        for(std::size_t layer = 0; layer < 100; ++layer) {
+            for(std::size_t i = 0; i < 4; ++i) {
+                auto time = graph[1 + layer * 4 + i].getResult<int>() - run * 402;
+                assert(time > static_cast<int>(layer * 4) && time <= static_cast<int>(layer * 4 + 4));
+            }
+        }
+    }
+    pool.wait();
+
+    // The nodes pushed to a pool which drops them are cancelled, and the graph still finishes
+    using namespace std::chrono;
+    man::ThreadPool droppingPool{1};
+    man::TaskGraph<> droppedGraph;
+    std::atomic<bool> isStarted{false};
+    auto root = droppedGraph.addNode([&isStarted]() noexcept {
+        isStarted = true;
+        std::this_thread::sleep_for(milliseconds{50});
+    });
+    std::vector<std::size_t> leaves;
+    for(int i = 0; i < 4; ++i) {
+        leaves.push_back(droppedGraph.addNode(Step{&clock}));
+        droppedGraph.addEdge(root, leaves.back());
+    }
+    auto sink = droppedGraph.addNode(Step{&clock});
+    for(auto leaf : leaves) {
+        droppedGraph.addEdge(leaf, sink);
+    }
+
+    droppedGraph.run(droppingPool);
+    man::TaskHandle<void> sinkHandle{&droppedGraph[sink]};
+    auto afterSink = sinkHandle.then([]() noexcept {});
+    while(!isStarted) {
+        std::this_thread::yield();
+    }
+    droppingPool.shutdown(man::ShutdownMode::DROP_PENDING);
+    droppedGraph.wait();
+    assert(!droppedGraph.isRunning() && droppedGraph.isCancelled());
+    // The cancelled nodes are finished, so their waiters and continuations are released
+    sinkHandle.wait();
+    assert(droppedGraph[sink].isCancelled() && afterSink.isReady() && afterSink.isCancelled());
+    assert(std::all_of(leaves.begin(), leaves.end(), [&droppedGraph](std::size_t leaf) {
+        return droppedGraph[leaf].isFinished();
+    }));
+    assert(std::count_if(leaves.begin(), leaves.end(), [&droppedGraph](std::size_t leaf) {
+        return droppedGraph[leaf].isCancelled();
+    }) >= 3);
+}
+}
+
+namespace testPriority {
+template<std::size_t FairnessPeriod>
+using PriorityPool = man::ThreadPoolWithContextsAndArgs<man::type_list<>, man::type_list<>,
+                                                        man::priority_queue_politic<FairnessPeriod>>;
+
+struct Record {
+    void operator()() noexcept {
+        m_order->push_back(m_name);
+    }
+
+    std::vector<char> *m_order;
+    char m_name;
+};
+
+struct Gate {
+    void operator()() noexcept {
+        while(!m_isOpen->load()) {
+            std::this_thread::yield();
+        }
+    }
+
+    std::atomic<bool> *m_isOpen;
+};
+
+/**
+ * The only worker is blocked while submit is called
+ */
+template<typename Pool, typename F>
+void submitWhileBlocked(Pool &priorityPool, F submit) {
+    std::atomic<bool> isOpen{false};
+    auto gate = priorityPool.addRunnable(Gate{&isOpen});
+    while(!gate->isStarted());
+    submit();
+    isOpen = true;
+    priorityPool.wait();
+    priorityPool.clear();
+}
+
+void test() {
+    std::vector<char> order;
+    PriorityPool<16> priorityPool{1};
+
+    submitWhileBlocked(priorityPool, [&] {
+        priorityPool.addRunnableAndForget(man::Priority::BACKGROUND, Record{&order, 'b'});
+        priorityPool.addRunnableAndForget(Record{&order, 'n'});
+        priorityPool.addRunnableAndForget(std::chrono::steady_clock::now() + std::chrono::seconds{1}, Record{&order, 'l'});
+        priorityPool.addRunnableAndForget(std::chrono::steady_clock::now() + std::chrono::milliseconds{1}, Record{&order, 'e'});
+        priorityPool.addRunnableAndForget(man::Priority::INTERACTIVE, Record{&order, 'i'});
+    });
+    assert((order == std::vector<char>{'i', 'e', 'l', 'n', 'b'}));
+
+    // The fourth pop serves the background priority even if interactive runnables are waiting
+    order.clear();
+    PriorityPool<4> fairPool{1};
+
+    submitWhileBlocked(fairPool, [&] {
+        fairPool.addRunnableAndForget(man::Priority::BACKGROUND, Record{&order, 'b'});
+        for(int i = 0; i < 4; ++i) {
+            fairPool.addRunnableAndForget(man::Priority::INTERACTIVE, Record{&order, 'i'});
+        }
+    });
+    assert((order == std::vector<char>{'i', 'i', 'b', 'i', 'i'}));
+}
+}
+
+namespace testProducers {
+template<typename Pool>
+struct Fibonacci {
+    void operator()() noexcept {
+        if(m_n < 2) {
+            *m_sum += m_n;
+        }
+
+        else {
+            m_pool->addRunnableAndForget(Fibonacci{m_pool, m_sum, m_n - 1});
+            m_pool->addRunnableAndForget(Fibonacci{m_pool, m_sum, m_n - 2});
+        }
+    }
+
+    Pool *m_pool;
+    std::atomic<int> *m_sum;
+    int m_n;
+};
+
+template<typename Pool>
+void test() {
+    Pool producersPool{3};
+    std::atomic<int> sum{0};
+    std::vector<std::thread> producers;
+
+    // Many threads submit at the same time
+    for(int i = 0; i < 4; ++i) {
+        producers.emplace_back([&producersPool, &sum] {
+            for(int j = 0; j < 2500; ++j) {
+                producersPool.addRunnableAndForget([&sum]() noexcept {sum++;});
+            }
+            auto future = producersPool.addRunnable([]() noexcept {return 42;});
+            assert(future.get() == 42);
+        });
+    }
+
+    for(auto &producer : producers) {
+        producer.join();
+    }
+    producersPool.wait();
+    assert(sum == 10000);
+
+    // Tasks spawn their subtasks into their own pool
+    sum = 0;
+    producersPool.addRunnableAndForget(Fibonacci<Pool>{&producersPool, &sum, 20});
+    producersPool.wait();
+    assert(sum == 6765);
+    producersPool.clear();
+}
+
+void test() {
+    test<man::ThreadPool>();
+    test<man::WorkStealingThreadPool>();
+}
+}
+
+namespace testTopology {
+void test() {
+    auto &topology = man::Topology::current();
+    assert(!topology.cpus().empty());
+    assert(topology.numberOfNodes() >= 1);
+    auto cpu = topology.cpus().front().m_cpu;
+    assert(topology.distance(cpu, cpu) == man::Topology::SAME_CPU);
+
+    // A pinned worker creates its context on its cpu, and runs there
+    man::ThreadPoolWithContext<int> pinnedPool{man::ThreadPoolOptions::pinnedToCpus(4),
+                                               [] {return man::getCurrentCpu();}};
+    std::vector<man::Future<bool, man::Runnable<int&>>> futures;
+    for(int i = 0; i < 100; ++i) {
+        futures.push_back(pinnedPool.addRunnable([](int &cpuOfContext) noexcept {
+            return cpuOfContext == man::getCurrentCpu();
+        }));
+    }
+    pinnedPool.wait();
+    for(auto &future : futures) {
+        assert(future.get());
+    }
+    pinnedPool.clear();
+
+    // The distances come from the topology the workers were pinned from
+    man::Topology fakeTopology{{{0, 0, 0, 0, 0}, {1, 1, 0, 0, 0}, {2, 2, 1, 1, 1}, {3, 3, 1, 1, 1}}};
+    auto fakeDistances = man::ThreadPoolOptions::pinnedToCpus(4, fakeTopology).distancesBetweenWorkers();
+    assert(fakeDistances[0][1] == man::Topology::SAME_CACHE && fakeDistances[0][2] == man::Topology::REMOTE);
+    assert(man::ThreadPoolOptions::pinnedToNodes(4, fakeTopology).distancesBetweenWorkers()[0][3] == man::Topology::REMOTE);
+
+    // Without any cpu, the workers are not pinned
+    assert(man::ThreadPoolOptions::pinnedToNodes(4, man::Topology{}).m_cpuSets.empty());
+
+    // The nearest victims are tried first, in turn from the given start
+    man::DistanceMatrix distances{{0, 2, 1, 2}, {2, 0, 2, 1}, {1, 2, 0, 2}, {2, 1, 2, 0}};
+    man::VictimOrder order{0, 4, distances};
+    std::vector<std::size_t> visited;
+    auto visit = [&visited](std::size_t victim) -> int* {
+        visited.push_back(victim);
+        return nullptr;
+    };
+    order.find(0, visit);
+    assert((visited == std::vector<std::size_t>{2, 1, 3}));
+    visited.clear();
+    order.find(1, visit);
+    assert((visited == std::vector<std::size_t>{2, 3, 1}));
+}
+}
+
+namespace testElastic {
+struct Tracker {
+    Tracker(std::atomic<int> &alive) noexcept : m_alive{&alive} {
+        ++*m_alive;
+    }
+
+    Tracker(Tracker &&other) noexcept : m_alive{std::exchange(other.m_alive, nullptr)} {}
+
+    ~Tracker() noexcept {
+        if(m_alive != nullptr) {
+            --*m_alive;
+        }
+    }
+
+    std::atomic<int> *m_alive;
+};
+
+void test() {
+    using namespace std::chrono;
+    std::atomic<int> alive{0};
+    man::ThreadPoolWithContext<Tracker> pool{man::ThreadPoolOptions::elastic(1, 4, milliseconds{20}),
+                                             [&alive]() -> Tracker {return alive;}};
+    assert(pool.getNumberOfThreads() == 1);
+    assert(pool.getMaximumNumberOfThreads() == 4);
+
+    std::atomic<int> done{0};
+    for(int i = 0; i < 64; ++i) {
+        pool.addRunnable([&done](Tracker &) noexcept {
+            std::this_thread::sleep_for(milliseconds{1});
+            ++done;
+        });
+    }
+    assert(pool.getNumberOfThreads() > 1);
+    pool.wait();
+    assert(done == 64);
+
+    // The spawned workers retire once they are idle, with their contexts
+    auto deadline = steady_clock::now() + seconds{5};
+    while((pool.getNumberOfThreads() > 1 || alive > 1) && steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(milliseconds{10});
+    }
+    assert(pool.getNumberOfThreads() == 1);
+    assert(alive == 1);
+
+    // It grows again with the next load
+    for(int i = 0; i < 64; ++i) {
+        pool.addRunnable([&done](Tracker &) noexcept {++done;});
+    }
+    pool.wait();
+    assert(done == 128);
+
+    // The number of workers changes while parallel_reduce runs
+    std::atomic<bool> isSubmitting{true};
+    std::thread submitter{[&pool, &isSubmitting] {
+        while(isSubmitting) {
+            pool.addRunnableAndForget([](Tracker &) noexcept {std::this_thread::sleep_for(microseconds{100});});
+            std::this_thread::sleep_for(microseconds{20});
+        }
+    }};
+    for(int i = 0; i < 20; ++i) {
+        assert(man::parallel_reduce(pool, 0, 10000, 0L, std::plus<>{}, 16) == 49995000L);
+    }
+    isSubmitting = false;
+    submitter.join();
+    pool.wait();
+    pool.clear();
+}
+}
+
+namespace testCancellation {
+void test() {
+    using namespace std::chrono;
+    man::ThreadPool pool{1};
+    std::atomic<bool> isBlocked{true};
+    std::atomic<int> numberOfRuns{0};
+    auto block = [&isBlocked]() noexcept {
+        while(isBlocked) {
+            std::this_thread::yield();
+        }
+    };
+
+    // A cancelled runnable is not run, and neither are its continuations
+    auto blocker = pool.addRunnable(block);
+    auto cancelled = pool.addRunnable([&numberOfRuns]() noexcept {return ++numberOfRuns;});
+    auto continuation = cancelled.then([&numberOfRuns](int &) noexcept {++numberOfRuns;});
+    auto kept = pool.addRunnable([&numberOfRuns]() noexcept {return ++numberOfRuns;});
+    assert(cancelled.cancel());
+
+    // A token cancels a group, a started task sees it
+    man::CancellationSource source;
+    auto token = source.token();
+    for(int i = 0; i < 10; ++i) {
+        pool.addRunnableAndForget(token, [&numberOfRuns]() noexcept {++numberOfRuns;});
+    }
+    source.cancel();
+    isBlocked = false;
+    pool.wait();
+
+    assert(blocker.isReady() && !blocker.cancel());
+    assert(cancelled.isReady() && cancelled.isCancelled());
+    assert(continuation.isReady() && continuation.isCancelled());
+    assert(kept.get() == 1);
+    assert(numberOfRuns == 1);
+
+    bool hasThrown = false;
+    try {
+        cancelled.get();
+    } catch(const std::runtime_error &) {
+        hasThrown = true;
+    }
+    assert(hasThrown);
+
+    man::CancellationSource runningSource;
+    std::atomic<bool> isStarted{false};
+    auto polling = pool.addRunnable(runningSource.token(), [&isStarted, token = runningSource.token()]() noexcept {
+        isStarted = true;
+        while(!token.isCancelled()) {
+            std::this_thread::yield();
+        }
+        return true;
+    });
+    while(!isStarted) {
+        std::this_thread::yield();
+    }
+    runningSource.cancel();
+    assert(polling.get());
+    pool.clear();
+
+    // The pending runnables are dropped, only the running one delays the shutdown
+    man::ThreadPool droppingPool{1};
+    isStarted = false;
+    droppingPool.addRunnableAndForget([&isStarted]() noexcept {
+        isStarted = true;
+        std::this_thread::sleep_for(milliseconds{50});
+    });
+    for(int i = 0; i < 1000; ++i) {
+        droppingPool.addRunnableAndForget([&numberOfRuns]() noexcept {++numberOfRuns;});
+    }
+    while(!isStarted) {
+        std::this_thread::yield();
+    }
+    droppingPool.shutdown(man::ShutdownMode::DROP_PENDING);
+    assert(numberOfRuns == 1);
+}
+}
+
+namespace testIssueChannel {
+void test() {
+    man::ThreadPool pool{2};
+    man::ProgressAggregate progress{100};
+    assert(static_cast<float>(progress.progression()) == 0.0f);
+
+    for(int i = 0; i < 10; ++i) {
+        pool.addRunnableAndForget([i, &progress]() noexcept {
+            man::reportIssue(i % 2 == 0 ? "even" : "odd", man::KindOfError::WARNING);
+            progress.complete(10);
+        });
+    }
+    pool.wait();
+    assert(static_cast<float>(progress.progression()) == 1.0f);
+
+    int numberOfEvens = 0;
+    auto numberOfIssues = pool.getIssueChannel().consume([&numberOfEvens](const man::IssueRecord &record) {
+        assert(record.m_kind == man::KindOfError::WARNING);
+        assert(record.m_worker < 2);
+        numberOfEvens += record.message() == "even";
+    });
+    assert(numberOfIssues == 10 && numberOfEvens == 5);
+    assert(pool.getIssueChannel().consume([](const man::IssueRecord &) {}) == 0);
+
+    // The long messages are truncated, a full ring drops the new issues
+    std::string longMessage(MAN_ISSUE_MESSAGE_SIZE * 2, 'x');
+    pool.addRunnableAndForget([&longMessage]() noexcept {
+        for(int i = 0; i < MAN_ISSUE_RING_SIZE + 1; ++i) {
+            man::reportIssue(longMessage, man::KindOfError::ERROR);
+        }
+    });
+    pool.wait();
+    assert(pool.getIssueChannel().getNumberOfDroppedIssues() == 1);
+    pool.getIssueChannel().consume([](const man::IssueRecord &record) {
+        assert(record.message().size() == MAN_ISSUE_MESSAGE_SIZE);
+        assert(record.toIssue() == man::Issue(std::string(MAN_ISSUE_MESSAGE_SIZE, 'x'), man::KindOfError::ERROR));
+    });
+
+    // Only the workers report issues
+    assert(!man::reportIssue("main thread"));
+    pool.clear();
+}
+}
+
+namespace testTaskGroup {
+void test() {
+    man::ThreadPool pool{1};
+    man::TaskGroup<man::ThreadPool> group{pool};
+    std::atomic<int> numberOfRuns{0};
+
+    for(int i = 0; i < 100; ++i) {
+        group.add([&numberOfRuns]() noexcept {++numberOfRuns;});
+    }
+    group.wait();
+    assert(group.isFinished() && numberOfRuns == 100);
+
+    // With only one worker, a task waiting for its nested group must run the nested tasks itself
+    man::TaskGroup<man::ThreadPool> parent{pool};
+    std::atomic<int> numberOfNestedRuns{0};
+    for(int i = 0; i < 4; ++i) {
+        parent.add([&parent, &numberOfNestedRuns]() noexcept {
+            man::TaskGroup<man::ThreadPool> nested{parent};
+            for(int j = 0; j < 10; ++j) {
+                nested.add([&numberOfNestedRuns]() noexcept {++numberOfNestedRuns;});
+            }
+            nested.wait();
+            assert(nested.isFinished());
+        });
+    }
+    parent.wait();
+    assert(numberOfNestedRuns == 40);
+
+    // The tasks of a cancelled group which are not started are not run
+    std::atomic<bool> isBlocked{true};
+    pool.addRunnableAndForget([&isBlocked]() noexcept {
+        while(isBlocked) {
+            std::this_thread::yield();
+        }
+    });
+    man::TaskGroup<man::ThreadPool> cancelled{pool};
+    for(int i = 0; i < 10; ++i) {
+        cancelled.add([&numberOfRuns]() noexcept {++numberOfRuns;});
+    }
+    cancelled.cancel();
+    isBlocked = false;
+    cancelled.wait();
+    assert(numberOfRuns == 100);
+
+    // The contexts and the arguments of the pool are given to the tasks
+    man::ThreadPoolWithContextsAndArgs<man::type_list<int>, man::type_list<int>> contextPool{2, [] {return 1;}};
+    man::TaskGroup<decltype(contextPool)> contextGroup{contextPool};
+    std::atomic<int> sum{0};
+    for(int i = 0; i < 10; ++i) {
+        contextGroup.add([&sum](int &context, int value) noexcept {sum += context + value;}, i);
+    }
+    contextGroup.wait();
+    assert(sum == 10 + 45);
+
+    // A group destroyed as soon as wait returns is not used anymore by its last task
+    for(int i = 0; i < 1000; ++i) {
+        man::TaskGroup<man::ThreadPool> shortLived{pool};
+        shortLived.add([]() noexcept {});
+        shortLived.wait();
+    }
+    pool.wait();
+}
+}
+
+namespace testArena {
+void test() {
+    using Pool = man::ThreadPoolWithContext<man::ArenaContext>;
+    auto allocate = [](man::ArenaContext &arena) noexcept {
+        std::pmr::vector<char> scratch{arena.allocator<char>()};
+        scratch.reserve(1000);
+        scratch.assign(1000, 'a');
+        return scratch.get_allocator().resource() == arena.resource();
+    };
+
+    // Reset after each task : the buffer is never exhausted
+    Pool pool{2, [] {return man::ArenaContext{4096};}};
+    std::vector<man::TaskHandle<bool, man::Runnable<man::ArenaContext&>>> handles;
+    for(int i = 0; i < 100; ++i) {
+        handles.push_back(pool.addRunnable(allocate));
+    }
+    pool.wait();
+    for(auto &handle : handles) {
+        assert(handle.get());
+    }
+
+    std::atomic<std::size_t> numberOfOverflows{0};
+    auto countOverflows = [&numberOfOverflows](man::ArenaContext &arena) noexcept {
+        numberOfOverflows += arena.getNumberOfOverflows();
+    };
+    pool.addRunnable(countOverflows);
+    pool.addRunnable(countOverflows);
+    pool.wait();
+    assert(numberOfOverflows == 0);
+    pool.clear();
+
+    // Reset after every 100 tasks : the arena falls back to upstream
+    Pool batchPool{1, [] {return man::ArenaContext{4096, 100};}};
+    for(int i = 0; i < 10; ++i) {
+        batchPool.addRunnable(allocate);
+    }
+    batchPool.wait();
+    numberOfOverflows = 0;
+    batchPool.addRunnable(countOverflows);
+    batchPool.wait();
+    assert(numberOfOverflows > 0);
+
+    // The overflows may be read by another thread while the worker allocates
+    std::atomic<man::ArenaContext*> watched{nullptr};
+    batchPool.addRunnable([&watched](man::ArenaContext &arena) noexcept {watched = &arena;});
+    batchPool.wait();
+    for(int i = 0; i < 99; ++i) {
+        batchPool.addRunnable(allocate);
+    }
+    auto last = batchPool.addRunnable(allocate);
+    auto numberOfOverflowsRead = watched.load()->getNumberOfOverflows();
+    while(!last.isReady()) {
+        auto current = watched.load()->getNumberOfOverflows();
+        assert(current >= numberOfOverflowsRead);
+        numberOfOverflowsRead = current;
+    }
+    batchPool.wait();
+    assert(watched.load()->getNumberOfOverflows() >= numberOfOverflowsRead);
+    batchPool.clear();
+}
+}
+
+namespace testPipeline {
+void test() {
+    man::Channel<std::string> channel{3};
+    assert(channel.capacity() == 4 && channel.isEmpty());
+    for(int i = 0; i < 4; ++i) {
+        assert(channel.tryPush(std::to_string(i)));
+    }
+    std::string refused = "4";
+    assert(!channel.tryPush(std::move(refused)) && refused == "4");
+    assert(channel.tryPop() == "0" && channel.tryPop() == "1");
+
+    man::ThreadPool pool{2};
+    std::atomic<bool> isSerialStageRunning{false};
+    std::atomic<std::size_t> maximumNumberOfItems{0};
+    std::vector<int> results;
+
+    auto pipeline = man::makePipeline<int>(pool, 16, 4)
+        .addStage(man::StageMode::PARALLEL, [](int value) noexcept {return std::to_string(value * 2);})
+        .addStage(man::StageMode::PARALLEL, [](std::string text) noexcept {return std::stoi(text) + 1;})
+        .addStage(man::StageMode::SERIAL, [&](int value) noexcept {
+            assert(!isSerialStageRunning.exchange(true));
+            std::this_thread::sleep_for(std::chrono::microseconds{50});
+            results.push_back(value);
+            isSerialStageRunning = false;
+        });
+
+    // The slow serial stage stalls the producer
+    for(int i = 0; i < 1000; ++i) {
+        pipeline.push(i);
+        maximumNumberOfItems = std::max<std::size_t>(maximumNumberOfItems, pipeline.getNumberOfItems());
+    }
+    pipeline.wait();
+    assert(!pipeline.isRunning());
+    assert(maximumNumberOfItems <= 16);
+    assert(results.size() == 1000);
+    std::sort(results.begin(), results.end());
+    for(int i = 0; i < 1000; ++i) {
+        assert(results[i] == 2 * i + 1);
+    }
+
+    int refusedItem = 0;
+    std::size_t numberOfRefusals = 0;
+    for(int i = 0; i < 100; ++i) {
+        refusedItem = i;
+        numberOfRefusals += !pipeline.tryPush(std::move(refusedItem));
+    }
+    pipeline.wait();
+    assert(results.size() + numberOfRefusals == 1100);
+
+    // Through serial stages only, the items go out in the order they were pushed
+    std::vector<int> ordered;
+    auto serialPipeline = man::makePipeline<int>(pool, 8, 3)
+        .addStage(man::StageMode::SERIAL, [](int value) noexcept {return value + 1;})
+        .addStage(man::StageMode::SERIAL, [](int value) noexcept {return std::to_string(value);})
+        .addStage(man::StageMode::SERIAL, [&ordered](std::string text) noexcept {ordered.push_back(std::stoi(text));});
+    for(int i = 0; i < 1000; ++i) {
+        serialPipeline.push(i);
+    }
+    serialPipeline.wait();
+    assert(ordered.size() == 1000);
+    for(int i = 0; i < 1000; ++i) {
+        assert(ordered[i] == i + 1);
+    }
+    pool.clear();
+}
+}
+
+namespace testTimer {
+void test() {
+    using namespace std::chrono;
+    man::ThreadPool pool{2};
+
+    auto start = steady_clock::now();
+    auto delayed = pool.addRunnableAfter(milliseconds{20}, [start]() noexcept {return steady_clock::now() - start;});
+    auto atTime = pool.addRunnableAt(start + milliseconds{10}, []() noexcept {return 42;});
+    auto cancelled = pool.addRunnableAfter(milliseconds{10}, []() noexcept {assert(false);});
+    cancelled.cancel();
+    assert(atTime.get() == 42);
+    assert(delayed.get() >= milliseconds{20});
+    pool.wait();
+    assert(cancelled.isReady() && cancelled.isCancelled());
+
+    // A cancelled runnable is not waited for until its time
+    auto far = pool.addRunnableAfter(seconds{10}, []() noexcept {assert(false);});
+    auto beforeCancel = steady_clock::now();
+    assert(far.cancel());
+    pool.wait();
+    assert(far.isCancelled() && steady_clock::now() - beforeCancel < seconds{5});
+
+    std::atomic<int> numberOfRuns{0};
+    auto periodic = pool.addPeriodic(milliseconds{2}, [&numberOfRuns]() noexcept {numberOfRuns++;});
+    while(numberOfRuns < 3) {
+        std::this_thread::sleep_for(milliseconds{1});
+    }
+    assert(pool.cancelTimer(periodic));
+    assert(!pool.cancelTimer(periodic));
+    pool.wait();
+    auto numberOfRunsAfterCancel = numberOfRuns.load();
+    std::this_thread::sleep_for(milliseconds{10});
+    assert(numberOfRuns == numberOfRunsAfterCancel);
+
+    // Many timers are added and cancelled without scanning the others
+    man::TimerWheel wheel;
+
+    // A timer never fires before its time, even when it is not a whole number of ticks
+    std::vector<steady_clock::time_point> deadlines(9);
+    std::vector<steady_clock::time_point> fireTimes(9);
+    std::atomic<int> numberOfEarlyTimers{0};
+    for(int i = 0; i < 9; ++i) {
+        deadlines[i] = steady_clock::now() + microseconds{100 * (i + 1)};
+        wheel.addAt(deadlines[i], [&fireTimes, &numberOfEarlyTimers, i] {
+            fireTimes[i] = steady_clock::now();
+            numberOfEarlyTimers++;
+        });
+    }
+    while(numberOfEarlyTimers < 9) {
+        std::this_thread::sleep_for(microseconds{100});
+    }
+    for(int i = 0; i < 9; ++i) {
+        assert(fireTimes[i] >= deadlines[i]);
+    }
+
+    // Cancelling a firing timer waits for its callback only, not for a timer reusing its node
+    std::atomic<bool> isFiring{false};
+    std::atomic<bool> isReusing{false};
+    auto firstDeadline = steady_clock::now() + milliseconds{5};
+    auto firing = wheel.addAt(firstDeadline, [&isFiring] {
+        isFiring = true;
+        std::this_thread::sleep_for(milliseconds{50});
+    });
+    wheel.addAt(firstDeadline, [&wheel, &isReusing] {
+        // The node of the first timer is free once its callback returned, and a past timer fires in this tick
+        wheel.addAt(steady_clock::time_point{}, [&isReusing] {
+            isReusing = true;
+            std::this_thread::sleep_for(milliseconds{500});
+        });
+    });
+    while(!isFiring) {
+        std::this_thread::yield();
+    }
+    auto beforeFiringCancel = steady_clock::now();
+    assert(!wheel.cancel(firing));
+    assert(steady_clock::now() - beforeFiringCancel < milliseconds{400});
+    while(!isReusing) {
+        std::this_thread::yield();
+    }
+
+    std::vector<man::TimerId> ids;
+    std::atomic<int> numberOfFired{0};
+    for(int i = 0; i < 20000; ++i) {
+        ids.push_back(wheel.addAt(steady_clock::now() + seconds{1 + i % 3600}, [&numberOfFired] {numberOfFired++;}));
+    }
+    assert(wheel.getNumberOfTimers() == 20000);
+    for(std::size_t i = 0; i < ids.size(); i += 2) {
+        assert(wheel.cancel(ids[i]));
+    }
+    assert(wheel.getNumberOfTimers() == 10000);
+    wheel.expireAll();
+    assert(numberOfFired == 10000 && wheel.getNumberOfTimers() == 0);
+
+    auto dropped = pool.addRunnableAfter(seconds{60}, []() noexcept {assert(false);});
+    pool.shutdown(man::ShutdownMode::DROP_PENDING);
+    assert(dropped.isReady() && dropped.isCancelled());
+    pool.clear();
+
+    // The destructor drops the timers which did not fire
+    std::atomic<int> numberOfPeriodicRuns{0};
+    {
+        man::ThreadPool timedPool{1};
+        timedPool.addRunnableAfter(seconds{60}, []() noexcept {assert(false);});
+        timedPool.addPeriodic(seconds{60}, [&numberOfPeriodicRuns]() noexcept {numberOfPeriodicRuns++;});
+    }
+    assert(numberOfPeriodicRuns == 0);
+}
+}
+
+namespace testClock {
+template<typename ClockPolitic>
+using Pool = man::ThreadPoolWithContextsAndArgs<man::type_list<>, man::type_list<>, ClockPolitic>;
+
+void test() {
+    using namespace std::chrono;
+    static_assert(sizeof(man::BasicRunnable<man::no_clock_politic>) < sizeof(man::Runnable<>));
+
+    Pool<man::no_clock_politic> untimedPool{2};
+    auto untimed = untimedPool.addRunnable([]() noexcept {return 42;});
+    assert(untimed.get() == 42);
+    untimedPool.clear();
+
+    Pool<man::tsc_clock_politic> tscPool{2};
+    auto timed = tscPool.addRunnable([]() noexcept {std::this_thread::sleep_for(milliseconds{20});});
+    timed.wait();
+    assert(timed->getElapsedTime<milliseconds>() >= milliseconds{15});
+    assert(timed->getElapsedTime<milliseconds>() < seconds{1});
+    tscPool.clear();
+}
+}
+
+#if MAN_ENABLE_METRICS
+namespace testMetrics {
+template<typename Pool>
+void test() {
+    Pool pool{4};
+    for(int i = 0; i < 1000; ++i) {
+        pool.addRunnableAndForget([]() noexcept {
+            std::this_thread::sleep_for(std::chrono::microseconds{1});
+        });
+    }
+    pool.wait();
+
+    // The workers keep running while the counters are read
+    auto snapshot = pool.snapshot();
+    assert(snapshot.m_workers.size() == 4);
+    auto total = snapshot.total();
+    assert(total.m_executedTasks == 1000);
+    assert(total.m_stolenTasks <= total.m_executedTasks);
+    assert(total.m_executionTime >= std::chrono::microseconds{1000});
+    assert(total.m_queueDepth == 0);
+}
+
+void test() {
+    test<man::ThreadPool>();
+    test<man::WorkStealingThreadPool>();
+    test<man::ThreadPoolWithContextsAndArgs<man::type_list<>, man::type_list<>, man::priority_queue_politic<>>>();
+
+    // The nested tasks run by a waiting task are counted, but their time is not counted twice
+    using namespace std::chrono;
+    man::ThreadPool pool{1};
+    auto start = steady_clock::now();
+    pool.addRunnableAndForget([&pool]() noexcept {
+        man::TaskGroup<man::ThreadPool> group{pool};
+        for(int i = 0; i < 5; ++i) {
+            group.add([]() noexcept {std::this_thread::sleep_for(milliseconds{10});});
+        }
+        group.wait();
+    });
+    pool.wait();
+    auto elapsed = steady_clock::now() - start;
+    auto total = pool.snapshot().total();
+    assert(total.m_executedTasks == 6);
+    assert(total.m_executionTime >= milliseconds{50} && total.m_executionTime <= elapsed);
+}
+}
+#endif
+
+#if defined(MAN_HAS_COROUTINES)
+namespace testCoroutine {
+man::task<int> square(int value) {
+    co_await pool.schedule();
+    co_return value * value;
+}
+
+man::task<int> sumOfSquares(int n) {
+    int sum = 0;
+    for(int i = 1; i <= n; ++i) {
+        sum += co_await square(i);
+    }
+    co_return sum;
+}
+
+man::task<void> fail() {
+    co_await pool.schedule();
+    throw std::runtime_error("fail");
+}
+
+man::task<void> resumeOn(man::ThreadPool &onPool, std::atomic<bool> &isResumed) {
+    co_await onPool.schedule();
+    isResumed = true;
+}
+
+// Adds itself again until it is stopped, so the worker always has a runnable in its queue
+struct Flood {
+    void operator()() noexcept {
+        if(!*m_isStopped) {
+            m_pool->addRunnableAndForget(*this);
+        }
+    }
+
+    man::ThreadPool *m_pool;
+    std::atomic<bool> *m_isStopped;
+};
+
+void test() {
+    assert(man::syncWait(sumOfSquares(100)) == 338350);
+
+    // A steady flow of runnables does not starve the coroutines
+    man::ThreadPool singlePool{1};
+    std::atomic<bool> isResumed{false};
+    singlePool.addRunnableAndForget(Flood{&singlePool, &isResumed});
+    man::syncWait(resumeOn(singlePool, isResumed));
+    singlePool.wait();
+
+    // A task helping the pool while it waits resumes the coroutines too
+    isResumed = false;
+    singlePool.addRunnableAndForget([&singlePool, &isResumed]() noexcept {
+        while(!isResumed) {
+            if(!singlePool.runPendingRunnable()) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    man::syncWait(resumeOn(singlePool, isResumed));
+    singlePool.wait();
+
+    bool hasThrown = false;
+    try {
+        man::syncWait(fail());
+    } catch(const std::runtime_error &) {
+        hasThrown = true;
+    }
+    assert(hasThrown);
+
+    pool.wait();
+}
+}
+#endif
+
 int main() {
     std::cout << "==TEST RETURN VALUE==" << std::endl;
     testReturn::test();
@@ -132,6 +1347,56 @@ int main() {
     testArgs::test();
     std::cout << "==TEST ARGS OK==\n==TEST CONTEXT==" << std::endl;
     testContext::test();
-    std::cout << "==TEST CONTEXT OK==" << std::endl;
+    std::cout << "==TEST CONTEXT OK==\n==TEST WORK STEALING==" << std::endl;
+    testWorkStealing::test();
+    std::cout << "==TEST WORK STEALING OK==\n==TEST FORGET==" << std::endl;
+    testForget::test();
+    std::cout << "==TEST FORGET OK==\n==TEST INLINE==" << std::endl;
+    testInline::test();
+    std::cout << "==TEST INLINE OK==\n==TEST MONOMORPHIC==" << std::endl;
+    testMonomorphic::test();
+    std::cout << "==TEST MONOMORPHIC OK==\n==TEST FUTURE==" << std::endl;
+    testFuture::test();
+    std::cout << "==TEST FUTURE OK==\n==TEST TASK HANDLE==" << std::endl;
+    testTaskHandle::test();
+    std::cout << "==TEST TASK HANDLE OK==\n==TEST BULK==" << std::endl;
+    testBulk::test();
+    std::cout << "==TEST BULK OK==\n==TEST ALGORITHM==" << std::endl;
+    testAlgorithm::test();
+    std::cout << "==TEST ALGORITHM OK==\n==TEST TASK GRAPH==" << std::endl;
+    testTaskGraph::test();
+    std::cout << "==TEST TASK GRAPH OK==\n==TEST PRIORITY==" << std::endl;
+    testPriority::test();
+    std::cout << "==TEST PRIORITY OK==\n==TEST PRODUCERS==" << std::endl;
+    testProducers::test();
+    std::cout << "==TEST PRODUCERS OK==\n==TEST TOPOLOGY==" << std::endl;
+    testTopology::test();
+    std::cout << "==TEST TOPOLOGY OK==\n==TEST ELASTIC==" << std::endl;
+    testElastic::test();
+    std::cout << "==TEST ELASTIC OK==\n==TEST CANCELLATION==" << std::endl;
+    testCancellation::test();
+    std::cout << "==TEST CANCELLATION OK==\n==TEST ISSUE CHANNEL==" << std::endl;
+    testIssueChannel::test();
+    std::cout << "==TEST ISSUE CHANNEL OK==\n==TEST TASK GROUP==" << std::endl;
+    testTaskGroup::test();
+    std::cout << "==TEST TASK GROUP OK==\n==TEST ARENA==" << std::endl;
+    testArena::test();
+    std::cout << "==TEST ARENA OK==\n==TEST PIPELINE==" << std::endl;
+    testPipeline::test();
+    std::cout << "==TEST PIPELINE OK==\n==TEST TIMER==" << std::endl;
+    testTimer::test();
+    std::cout << "==TEST TIMER OK==\n==TEST CLOCK==" << std::endl;
+    testClock::test();
+    std::cout << "==TEST CLOCK OK==" << std::endl;
+#if MAN_ENABLE_METRICS
+    std::cout << "==TEST METRICS==" << std::endl;
+    testMetrics::test();
+    std::cout << "==TEST METRICS OK==" << std::endl;
+#endif
+#if defined(MAN_HAS_COROUTINES)
+    std::cout << "==TEST COROUTINE==" << std::endl;
+    testCoroutine::test();
+    std::cout << "==TEST COROUTINE OK==" << std::endl;
+#endif
     return 0;
 }
@@ -0,0 +1,218 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+#include "WaitPolitic.h"
+
+namespace man {
+namespace detail {
+/**
+ * Hands out the chunks of the range [0, size).
+ *
+ * The size of a chunk is proportional to what remains (guided self-scheduling) :
+ * the first chunks are large to make the scheduling cheap, the last ones are small
+ * so the workers which got the expensive elements are helped by the others.
+ */
+class ChunkDispenser {
+public:
+    ChunkDispenser(std::size_t size, std::size_t numberOfTasks, std::size_t grain) noexcept :
+        m_size{size}, m_divisor{2 * numberOfTasks}, m_grain{grain} {}
+
+    bool next(std::size_t &first, std::size_t &last) noexcept {
+        auto current = m_next.load(std::memory_order_relaxed);
+
+        do {
+            if(current >= m_size) {
+                return false;
+            }
+
+            auto chunk = std::max(m_grain, (m_size - current) / m_divisor);
+            last = std::min(m_size, current + chunk);
+        } while(!m_next.compare_exchange_weak(current, last, std::memory_order_relaxed));
+
+        first = current;
+        return true;
+    }
+
+private:
+    std::atomic<std::size_t> m_next{0};
+    std::size_t m_size;
+    std::size_t m_divisor;
+    std::size_t m_grain;
+};
+
+template<typename Body>
+struct ParallelState {
+    ParallelState(std::size_t size, std::size_t numberOfTasks, std::size_t grain, Body &body) noexcept :
+        m_chunks{size, numberOfTasks, grain}, m_runningTasks{numberOfTasks}, m_body{body} {}
+
+    // The state lives on the stack of the waiting thread, it is gone as soon as wait returns
+    void finishTask() noexcept {
+        m_runningTasks.finish();
+    }
+
+    void wait() noexcept {
+        m_runningTasks.wait();
+    }
+
+    ChunkDispenser m_chunks;
+    CompletionCounter m_runningTasks;
+    Body &m_body;
+};
+
+/**
+ * One task by worker : it runs chunks until the range is exhausted
+ */
+template<typename Body>
+struct ChunkTask {
+    template<typename ...Contexts>
+    void operator()(Contexts &...contexts) noexcept {
+        std::size_t first, last;
+
+        while(m_state->m_chunks.next(first, last)) {
+            m_state->m_body(m_task, first, last, contexts...);
+        }
+
+        m_state->finishTask();
+    }
+
+    ParallelState<Body> *m_state;
+    std::size_t m_task;
+};
+
+template<typename Pool>
+std::size_t numberOfTasks(const Pool &pool, std::size_t size, std::size_t grain) noexcept {
+    return std::min(pool.getNumberOfThreads(), (size + grain - 1) / grain);
+}
+
+/**
+ * Run body(task, first, last, contexts...) on chunks of [0, size) with tasks tasks, and wait for them.
+ *
+ * The number of tasks is given by the caller : the number of workers of an elastic pool may change meanwhile
+ */
+template<typename Pool, typename Body>
+void runChunks(Pool &pool, std::size_t size, std::size_t grain, std::size_t tasks, Body &&body) {
+    if(tasks == 0) {
+        return;
+    }
+
+    using State = ParallelState<std::remove_reference_t<Body>>;
+    State state{size, tasks, grain, body};
+
+    std::vector<ChunkTask<std::remove_reference_t<Body>>> chunkTasks;
+    chunkTasks.reserve(tasks);
+    for(std::size_t task{0}; task < tasks; ++task) {
+        chunkTasks.push_back({&state, task});
+    }
+
+    pool.addRunnablesAndForget(chunkTasks);
+    state.wait();
+}
+
+/**
+ * An index range [first, last) is iterated by value, other ranges through their iterator
+ */
+template<typename Iterator>
+decltype(auto) elementAt(Iterator first, std::size_t index) noexcept {
+    if constexpr(std::is_integral_v<Iterator>) {
+        return static_cast<Iterator>(first + static_cast<Iterator>(index));
+    }
+
+    else {
+        return first[static_cast<typename std::iterator_traits<Iterator>::difference_type>(index)];
+    }
+}
+
+template<typename Iterator>
+std::size_t distance(Iterator first, Iterator last) noexcept {
+    if constexpr(std::is_integral_v<Iterator>) {
+        return last > first ? static_cast<std::size_t>(last - first) : 0;
+    }
+
+    else {
+        return static_cast<std::size_t>(std::distance(first, last));
+    }
+}
+}
+
+/**
+ * Call f(contexts..., element) for each element of [first, last).
+ *
+ * first and last are random access iterators or integers.
+ * The range is split lazily : each worker runs one runnable which takes chunks
+ * of at least grain elements until the range is exhausted.
+ * The contexts are the ones of the worker running the element, given by reference,
+ * so they may be used as accumulators without lock.
+ *
+ * f must not throw. It blocks the calling thread, which must not be a worker of pool.
+ * The pool must not have Args.
+ */
+template<typename Pool, typename Iterator, typename F>
+void parallel_for(Pool &pool, Iterator first, Iterator last, F &&f, std::size_t grain = 1) {
+    grain = std::max<std::size_t>(grain, 1);
+
+    auto size = detail::distance(first, last);
+
+    detail::runChunks(pool, size, grain, detail::numberOfTasks(pool, size, grain),
+                      [first, &f](std::size_t, std::size_t begin, std::size_t end, auto &...contexts) {
+        for(auto i = begin; i < end; ++i) {
+            f(contexts..., detail::elementAt(first, i));
+        }
+    });
+}
+
+/**
+ * Reduce [first, last) with op, starting from identity.
+ *
+ * Each task accumulates its chunks on its own, and the partial results are merged
+ * by the calling thread at the end. They are kept by task rather than in the contexts
+ * of the workers, so T does not have to be a context of the pool. The order of the elements is not kept, so op
+ * must be associative and commutative, and identity must be neutral for op.
+ */
+template<typename Pool, typename Iterator, typename T, typename Op>
+T parallel_reduce(Pool &pool, Iterator first, Iterator last, T identity, Op &&op, std::size_t grain = 1) {
+    grain = std::max<std::size_t>(grain, 1);
+    auto size = detail::distance(first, last);
+    auto tasks = detail::numberOfTasks(pool, size, grain);
+    std::vector<T> partials(tasks, identity);
+
+    // Each task writes its own partial, so the number of tasks must not change
+    detail::runChunks(pool, size, grain, tasks,
+                      [first, &identity, &op, &partials](std::size_t task, std::size_t begin, std::size_t end, auto &...) {
+        auto accumulator = identity;
+        for(auto i = begin; i < end; ++i) {
+            accumulator = op(std::move(accumulator), detail::elementAt(first, i));
+        }
+        partials[task] = op(std::move(partials[task]), std::move(accumulator));
+    });
+
+    for(auto &partial : partials) {
+        identity = op(std::move(identity), std::move(partial));
+    }
+
+    return identity;
+}
+
+/**
+ * Store f(contexts..., element) for each element of [first, last) into out,
+ * which must be a random access iterator, and keep the order.
+ * @return The end of the output range
+ */
+template<typename Pool, typename Iterator, typename OutputIterator, typename F>
+OutputIterator parallel_transform(Pool &pool, Iterator first, Iterator last, OutputIterator out,
+                                  F &&f, std::size_t grain = 1) {
+    grain = std::max<std::size_t>(grain, 1);
+    auto size = detail::distance(first, last);
+
+    detail::runChunks(pool, size, grain, detail::numberOfTasks(pool, size, grain),
+                      [first, out, &f](std::size_t, std::size_t begin, std::size_t end, auto &...contexts) {
+        for(auto i = begin; i < end; ++i) {
+            detail::elementAt(out, i) = f(contexts..., detail::elementAt(first, i));
+        }
+    });
+
+    return out + static_cast<typename std::iterator_traits<OutputIterator>::difference_type>(size);
+}
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <algorithm>
+#include <memory_resource>
+
+namespace man {
+namespace detail {
+/**
+ * Forward the allocations to upstream, and count them : the arena calls it only when its buffer is exhausted.
+ *
+ * Only the worker owning the arena allocates, but the counter may be read from any thread
+ */
+class OverflowResource final : public std::pmr::memory_resource {
+public:
+    explicit OverflowResource(std::pmr::memory_resource *upstream) noexcept : m_upstream{upstream} {}
+
+    std::size_t getNumberOfOverflows() const noexcept {
+        return m_numberOfOverflows.load(std::memory_order_relaxed);
+    }
+
+private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+        // Only one thread writes the counter, a read-modify-write is not needed
+        m_numberOfOverflows.store(m_numberOfOverflows.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return m_upstream->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) override {
+        m_upstream->deallocate(pointer, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    std::pmr::memory_resource *m_upstream;
+    std::atomic<std::size_t> m_numberOfOverflows{0};
+};
+
+struct Arena {
+    Arena(std::size_t capacity, std::pmr::memory_resource *upstream) :
+        m_buffer{std::make_unique<std::byte[]>(capacity)},
+        m_overflow{upstream},
+        m_resource{m_buffer.get(), capacity, &m_overflow} {}
+
+    std::unique_ptr<std::byte[]> m_buffer;
+    OverflowResource m_overflow;
+    std::pmr::monotonic_buffer_resource m_resource;
+};
+}
+
+/**
+ * Context giving the tasks of a worker a monotonic arena of scratch memory
+ *
+ * An allocation bumps a pointer in the buffer of the worker, without lock. Nothing is released
+ * until the pool resets the arena, after every resetPeriod tasks of the worker : the memory must not
+ * outlive the task which allocated it. Once the buffer is exhausted, the arena allocates from upstream
+ * until its next reset. Give std::pmr::null_memory_resource() to throw std::bad_alloc instead.
+ */
+class ArenaContext {
+public:
+    explicit ArenaContext(std::size_t capacity = 64 * 1024, std::size_t resetPeriod = 1,
+                          std::pmr::memory_resource *upstream = std::pmr::new_delete_resource()) :
+        m_arena{std::make_unique<detail::Arena>(capacity, upstream)},
+        m_resetPeriod{std::max<std::size_t>(resetPeriod, 1)} {}
+
+    std::pmr::memory_resource *resource() noexcept {
+        return &m_arena->m_resource;
+    }
+
+    template<typename T = std::byte>
+    std::pmr::polymorphic_allocator<T> allocator() noexcept {
+        return std::pmr::polymorphic_allocator<T>{resource()};
+    }
+
+    /**
+     * Release everything allocated since the last reset
+     */
+    void reset() noexcept {
+        m_arena->m_resource.release();
+        m_numberOfTasksSinceReset = 0;
+    }
+
+    /**
+     * The number of allocations which did not fit in the buffer, since the arena was created.
+     *
+     * It may be read from any thread while the worker runs, the value is then approximate
+     */
+    std::size_t getNumberOfOverflows() const noexcept {
+        return m_arena->m_overflow.getNumberOfOverflows();
+    }
+
+    /**
+     * Called by the pool once a task of the worker is finished
+     */
+    friend void onTaskFinished(ArenaContext &arena) noexcept {
+        if(++arena.m_numberOfTasksSinceReset == arena.m_resetPeriod) {
+            arena.reset();
+        }
+    }
+
+private:
+    std::unique_ptr<detail::Arena> m_arena;
+    std::size_t m_resetPeriod;
+    std::size_t m_numberOfTasksSinceReset{0};
+};
+}
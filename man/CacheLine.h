@@ -0,0 +1,16 @@
+#pragma once
+#include <cstddef>
+
+/**
+ * The distance that keeps two objects written by different threads from sharing a cache line.
+ *
+ * std::hardware_destructive_interference_size is not used because its value may change
+ * between compilers and flags, and so the layout of the classes which use it
+ */
+#ifndef MAN_CACHE_LINE_SIZE
+#define MAN_CACHE_LINE_SIZE 64
+#endif
+
+namespace man {
+inline constexpr std::size_t cacheLineSize = MAN_CACHE_LINE_SIZE;
+}
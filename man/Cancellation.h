@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <memory>
+
+namespace man {
+/**
+ * What a task polls to know if its work is still wanted.
+ *
+ * A default constructed token is never cancelled. Polling it is one load,
+ * cheap enough to be done inside the loops of a task.
+ */
+class CancellationToken {
+    friend class CancellationSource;
+
+public:
+    CancellationToken() noexcept = default;
+
+    bool isCancelled() const noexcept {
+        return m_isCancelled != nullptr && m_isCancelled->load(std::memory_order_acquire);
+    }
+
+    bool canBeCancelled() const noexcept {
+        return m_isCancelled != nullptr;
+    }
+
+private:
+    explicit CancellationToken(std::shared_ptr<const std::atomic<bool>> isCancelled) noexcept :
+        m_isCancelled{std::move(isCancelled)} {}
+
+private:
+    std::shared_ptr<const std::atomic<bool>> m_isCancelled;
+};
+
+/**
+ * Cancel all the tokens it gave at once.
+ *
+ * The runnables added with one of its tokens are not run if they are not started
+ * when the source is cancelled, the started ones see it through their token
+ */
+class CancellationSource {
+public:
+    CancellationSource() : m_isCancelled{std::make_shared<std::atomic<bool>>(false)} {}
+
+    CancellationToken token() const noexcept {
+        return CancellationToken{m_isCancelled};
+    }
+
+    void cancel() noexcept {
+        m_isCancelled->store(true, std::memory_order_release);
+    }
+
+    bool isCancelled() const noexcept {
+        return m_isCancelled->load(std::memory_order_acquire);
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> m_isCancelled;
+};
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include <new>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <utility>
+#include <optional>
+#include "CacheLine.h"
+
+namespace man {
+/**
+ * Bounded queue with many producers and many consumers, without lock.
+ *
+ * Each cell carries a sequence number which tells if it may be written or read
+ * at the current position, so a producer and a consumer only meet on one cell.
+ * The capacity is rounded up to a power of two, a full channel refuses the new values.
+ */
+template<typename T>
+class Channel {
+    struct Cell {
+        std::atomic<std::size_t> m_sequence;
+        alignas(T) unsigned char m_value[sizeof(T)];
+    };
+
+public:
+    explicit Channel(std::size_t capacity) :
+        m_mask{roundUpToPowerOfTwo(capacity) - 1},
+        m_cells{std::make_unique<Cell[]>(m_mask + 1)} {
+        for(std::size_t i{0}; i <= m_mask; ++i) {
+            m_cells[i].m_sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    Channel(const Channel &) = delete;
+    Channel &operator=(const Channel &) = delete;
+
+    ~Channel() noexcept {
+        while(tryPop().has_value());
+    }
+
+    /**
+     * @return false if the channel is full, value is not moved then
+     */
+    bool tryPush(T &&value) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        auto position = m_back.load(std::memory_order_relaxed);
+        Cell *cell;
+
+        for(;;) {
+            cell = &m_cells[position & m_mask];
+            auto sequence = cell->m_sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+            if(difference == 0) {
+                if(m_back.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+
+            else if(difference < 0) {
+                return false;
+            }
+
+            else {
+                position = m_back.load(std::memory_order_relaxed);
+            }
+        }
+
+        new (cell->m_value) T(std::move(value));
+        cell->m_sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @return The oldest value, nothing if the channel is empty
+     */
+    std::optional<T> tryPop() noexcept(std::is_nothrow_move_constructible_v<T>) {
+        auto position = m_front.load(std::memory_order_relaxed);
+        Cell *cell;
+
+        for(;;) {
+            cell = &m_cells[position & m_mask];
+            auto sequence = cell->m_sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+
+            if(difference == 0) {
+                if(m_front.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+
+            else if(difference < 0) {
+                return std::nullopt;
+            }
+
+            else {
+                position = m_front.load(std::memory_order_relaxed);
+            }
+        }
+
+        auto pointer = std::launder(reinterpret_cast<T*>(cell->m_value));
+        std::optional<T> value{std::move(*pointer)};
+        pointer->~T();
+        cell->m_sequence.store(position + m_mask + 1, std::memory_order_release);
+        return value;
+    }
+
+    /**
+     * A value being pushed makes the channel not empty before it can be popped
+     */
+    bool isEmpty() const noexcept {
+        return m_front.load(std::memory_order_seq_cst) == m_back.load(std::memory_order_seq_cst);
+    }
+
+    std::size_t capacity() const noexcept {
+        return m_mask + 1;
+    }
+
+private:
+    static std::size_t roundUpToPowerOfTwo(std::size_t value) noexcept {
+        std::size_t power{1};
+        while(power < value) {
+            power *= 2;
+        }
+        return power;
+    }
+
+private:
+    std::size_t m_mask;
+    std::unique_ptr<Cell[]> m_cells;
+    alignas(cacheLineSize) std::atomic<std::size_t> m_back{0};
+    alignas(cacheLineSize) std::atomic<std::size_t> m_front{0};
+};
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <chrono>
+#include <thread>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define MAN_HAS_TSC 1
+#elif (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#define MAN_HAS_TSC 1
+#endif
+
+namespace man {
+struct clock_politic_tag{};
+
+/**
+ * Clock reading the time stamp counter of the cpu, converted into nanoseconds.
+ *
+ * The counter is calibrated against std::chrono::steady_clock the first time it is read, which sleeps
+ * for 10 ms : a pool timed with it reads it once when it is constructed, before any task is launched.
+ * The counter must be invariant, which is the case for every x86 cpu of the last decade.
+ * On other architectures, it is std::chrono::steady_clock.
+ */
+class TscClock {
+public:
+    using rep = std::int64_t;
+    using period = std::nano;
+    using duration = std::chrono::nanoseconds;
+    using time_point = std::chrono::time_point<TscClock>;
+    static constexpr bool is_steady = true;
+
+    static time_point now() noexcept {
+#if defined(MAN_HAS_TSC)
+        static const Calibration calibration = calibrate();
+        auto ticks = static_cast<double>(__rdtsc() - calibration.m_firstTick);
+        return time_point{duration{static_cast<rep>(ticks * calibration.m_nanosecondsByTick)}};
+#else
+        return time_point{std::chrono::duration_cast<duration>(std::chrono::steady_clock::now().time_since_epoch())};
+#endif
+    }
+
+private:
+#if defined(MAN_HAS_TSC)
+    struct Calibration {
+        std::uint64_t m_firstTick;
+        double m_nanosecondsByTick;
+    };
+
+    static Calibration calibrate() noexcept {
+        using namespace std::chrono;
+        auto firstTime = steady_clock::now();
+        auto firstTick = __rdtsc();
+        std::this_thread::sleep_for(milliseconds{10});
+        auto lastTime = steady_clock::now();
+        auto lastTick = __rdtsc();
+
+        auto elapsed = static_cast<double>(duration_cast<nanoseconds>(lastTime - firstTime).count());
+        return Calibration{firstTick, elapsed / static_cast<double>(lastTick - firstTick)};
+    }
+#endif
+};
+
+/**
+ * The runnables do not keep when they started and finished : launching them
+ * does not read any clock, and getElapsedTime and getRemainingTime do not compile
+ */
+struct no_clock_politic {
+    using politic_category = clock_politic_tag;
+    static constexpr bool isEnabled = false;
+};
+
+/**
+ * The runnables are timed with std::chrono::steady_clock
+ */
+struct steady_clock_politic {
+    using politic_category = clock_politic_tag;
+    static constexpr bool isEnabled = true;
+    using clock = std::chrono::steady_clock;
+};
+
+/**
+ * The runnables are timed with the time stamp counter of the cpu, cheaper to read than steady_clock.
+ *
+ * The constructor of the pool pays for the calibration of TscClock, about 10 ms, once by program
+ */
+struct tsc_clock_politic {
+    using politic_category = clock_politic_tag;
+    static constexpr bool isEnabled = true;
+    using clock = TscClock;
+};
+
+using default_clock_politic = steady_clock_politic;
+}
@@ -17,8 +17,14 @@ struct Concept {
     Concept(std::type_index returnTypeIndex) : m_returnTypeIndex(returnTypeIndex){}
     virtual ~Concept() noexcept = default;
 
+    /**
+     * Move construct the object at the address buffer
+     * @param buffer - Must be large enough and suitably aligned
+     * @return the moved object
+     */
+    virtual Concept *moveTo(void *buffer) noexcept = 0;
     virtual void launch(Args...) noexcept = 0;
-    virtual void retrieveResult(void *p) noexcept = 0;
+    virtual void *resultAddress() noexcept = 0;
     virtual std::optional<Progression> progression() const noexcept = 0;
     virtual std::vector<Issue> issues() const noexcept = 0;
 
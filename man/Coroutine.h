@@ -0,0 +1,289 @@
+#pragma once
+#include <exception>
+#include <optional>
+#include <utility>
+#include "InjectionQueue.h"
+#include "WaitPolitic.h"
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define MAN_HAS_COROUTINES 1
+#endif
+
+namespace man {
+/**
+ * Work that a thread pool resumes without any Runnable, like a suspended coroutine
+ */
+struct ResumableNode : QueueNode {
+    using ResumeFunction = void (*)(ResumableNode *) noexcept;
+
+    explicit ResumableNode(ResumeFunction resume) noexcept : m_resume{resume} {}
+
+    void resume() noexcept {
+        m_resume(this);
+    }
+
+    ResumeFunction m_resume;
+};
+
+#if defined(MAN_HAS_COROUTINES)
+/**
+ * Awaitable returned by pool.schedule()
+ *
+ * The awaiter lives inside the frame of the suspended coroutine, and is itself
+ * the item queued inside the pool : scheduling a coroutine does not allocate.
+ */
+template<typename Pool>
+class ScheduleOperation : public ResumableNode {
+public:
+    explicit ScheduleOperation(Pool &pool) noexcept :
+        ResumableNode{&ScheduleOperation::resumeCoroutine},
+        m_pool{pool} {}
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> coroutine) noexcept {
+        m_coroutine = coroutine;
+        m_pool.scheduleResumable(this);
+    }
+
+    void await_resume() const noexcept {}
+
+private:
+    static void resumeCoroutine(ResumableNode *node) noexcept {
+        static_cast<ScheduleOperation*>(node)->m_coroutine.resume();
+    }
+
+private:
+    Pool &m_pool;
+    std::coroutine_handle<> m_coroutine;
+};
+
+template<typename T = void>
+class task;
+
+namespace detail {
+class TaskPromiseBase {
+    struct FinalAwaiter {
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> coroutine) noexcept {
+            return coroutine.promise().m_continuation;
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+public:
+    std::suspend_always initial_suspend() const noexcept {
+        return {};
+    }
+
+    FinalAwaiter final_suspend() const noexcept {
+        return {};
+    }
+
+    void unhandled_exception() noexcept {
+        m_exception = std::current_exception();
+    }
+
+    void setContinuation(std::coroutine_handle<> continuation) noexcept {
+        m_continuation = continuation;
+    }
+
+protected:
+    void rethrowIfNeeded() const {
+        if(m_exception) {
+            std::rethrow_exception(m_exception);
+        }
+    }
+
+private:
+    std::coroutine_handle<> m_continuation{std::noop_coroutine()};
+    std::exception_ptr m_exception;
+};
+
+template<typename T>
+class TaskPromise : public TaskPromiseBase {
+public:
+    task<T> get_return_object() noexcept;
+
+    template<typename U>
+    void return_value(U &&value) {
+        m_value.emplace(std::forward<U>(value));
+    }
+
+    T result() {
+        rethrowIfNeeded();
+        return std::move(*m_value);
+    }
+
+private:
+    std::optional<T> m_value;
+};
+
+template<>
+class TaskPromise<void> : public TaskPromiseBase {
+public:
+    task<void> get_return_object() noexcept;
+
+    void return_void() const noexcept {}
+
+    void result() const {
+        rethrowIfNeeded();
+    }
+};
+}
+
+/**
+ * Lazy coroutine : it starts when it is awaited, on the thread that awaits it,
+ * and resumes its awaiter on the thread that finishes it.
+ *
+ * Awaiting a task never blocks a thread.
+ */
+template<typename T>
+class [[nodiscard]] task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+    explicit task(std::coroutine_handle<promise_type> coroutine) noexcept : m_coroutine{coroutine} {}
+
+    task(task &&other) noexcept : m_coroutine{std::exchange(other.m_coroutine, nullptr)} {}
+
+    task(const task &) = delete;
+    task &operator=(const task &) = delete;
+
+    ~task() noexcept {
+        if(m_coroutine) {
+            m_coroutine.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept {
+        return !m_coroutine || m_coroutine.done();
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+        m_coroutine.promise().setContinuation(awaiter);
+        return m_coroutine;
+    }
+
+    T await_resume() {
+        return m_coroutine.promise().result();
+    }
+
+    /**
+     * Awaitable that runs the task without retrieving its result
+     */
+    auto whenReady() noexcept {
+        struct WhenReady {
+            bool await_ready() const noexcept {
+                return m_task.await_ready();
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+                return m_task.await_suspend(awaiter);
+            }
+
+            void await_resume() const noexcept {}
+
+            task &m_task;
+        };
+        return WhenReady{*this};
+    }
+
+private:
+    std::coroutine_handle<promise_type> m_coroutine;
+};
+
+namespace detail {
+template<typename T>
+task<T> TaskPromise<T>::get_return_object() noexcept {
+    return task<T>{std::coroutine_handle<TaskPromise<T>>::from_promise(*this)};
+}
+
+inline task<void> TaskPromise<void>::get_return_object() noexcept {
+    return task<void>{std::coroutine_handle<TaskPromise<void>>::from_promise(*this)};
+}
+
+/**
+ * Coroutine used by syncWait to know when the awaited task is finished
+ */
+class SyncWaitTask {
+public:
+    struct promise_type {
+        SyncWaitTask get_return_object() noexcept {
+            return SyncWaitTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() const noexcept {
+            return {};
+        }
+
+        auto final_suspend() const noexcept {
+            struct Notifier {
+                bool await_ready() const noexcept {
+                    return false;
+                }
+
+                void await_suspend(std::coroutine_handle<promise_type> coroutine) const noexcept {
+                    // The waiter destroys the frame once it sees the task finished
+                    coroutine.promise().m_completion.finish();
+                }
+
+                void await_resume() const noexcept {}
+            };
+            return Notifier{};
+        }
+
+        void return_void() const noexcept {}
+
+        void unhandled_exception() const noexcept {
+            std::terminate();
+        }
+
+        CompletionCounter m_completion{1};
+    };
+
+    explicit SyncWaitTask(std::coroutine_handle<promise_type> coroutine) noexcept : m_coroutine{coroutine} {}
+
+    SyncWaitTask(const SyncWaitTask &) = delete;
+    SyncWaitTask &operator=(const SyncWaitTask &) = delete;
+
+    ~SyncWaitTask() noexcept {
+        m_coroutine.destroy();
+    }
+
+    template<typename WaitPolitic>
+    void startAndWait() noexcept {
+        m_coroutine.resume();
+        m_coroutine.promise().m_completion.template wait<WaitPolitic>();
+    }
+
+private:
+    std::coroutine_handle<promise_type> m_coroutine;
+};
+}
+
+/**
+ * Start the task on the calling thread, and block it until the task is finished
+ *
+ * It must not be called from a worker, it would block it
+ * @return The result of the task
+ */
+template<typename WaitPolitic = default_wait_politic, typename T>
+T syncWait(task<T> awaitable) {
+    auto waiter = [](task<T> &awaitable) -> detail::SyncWaitTask {
+        co_await awaitable.whenReady();
+    }(awaitable);
+
+    waiter.template startAndWait<WaitPolitic>();
+    return awaitable.await_resume();
+}
+#endif
+}
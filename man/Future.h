@@ -0,0 +1,158 @@
+#pragma once
+#include "Runnable.h"
+
+namespace man {
+template<typename R, typename RunnableType>
+class TaskHandle;
+
+namespace detail {
+/**
+ * A continuation that carries its own runnable, so it can be followed
+ * by other continuations
+ */
+struct ContinuationRunnable final : Continuation {
+    template<typename T>
+    ContinuationRunnable(T t) noexcept : m_runnable{std::move(t)} {}
+
+    void launch() noexcept override {
+        m_runnable.launch();
+    }
+
+    /**
+     * The continuation is finished without being run, and its own continuations are cancelled
+     */
+    void cancel() noexcept override {
+        m_runnable.cancel();
+        m_runnable.launch();
+    }
+
+    Runnable<> m_runnable;
+};
+}
+
+/**
+ * Typed handle on a runnable scheduled within a thread pool
+ *
+ * R is deduced from the task when it is submitted, so the type of the result
+ * is checked at compile time. The runnable is still reachable through operator-> and operator*
+ */
+template<typename R, typename RunnableType = Runnable<>>
+class TaskHandle {
+public:
+    using ResultType = R;
+
+    explicit TaskHandle(RunnableType *runnable) noexcept : m_runnable{runnable} {}
+
+    RunnableType *operator->() const noexcept {
+        return m_runnable;
+    }
+
+    RunnableType &operator*() const noexcept {
+        return *m_runnable;
+    }
+
+    RunnableType *getRunnable() const noexcept {
+        return m_runnable;
+    }
+
+    bool isReady() const noexcept {
+        return m_runnable->isFinished();
+    }
+
+    /**
+     * Cancel the runnable if it is not started : it is not run, and its continuations are cancelled.
+     *
+     * A started runnable is not interrupted, it may poll a CancellationToken
+     * @return true if the runnable will not be run
+     */
+    bool cancel() noexcept {
+        return m_runnable->cancel();
+    }
+
+    bool isCancelled() const noexcept {
+        return m_runnable->isCancelled();
+    }
+
+    template<typename WaitPolitic = default_wait_politic>
+    void wait() const noexcept {
+        m_runnable->template waitUntilFinished<WaitPolitic>();
+    }
+
+    /**
+     * Wait for the runnable and move its result out of it.
+     *
+     * The continuations added before the runnable is finished are done first, so they see the result.
+     * A continuation added afterwards runs at once and must not race with get
+     * @return R - The result of the runnable
+     * @throw std::runtime_error if the runnable was cancelled
+     */
+    template<typename WaitPolitic = default_wait_politic>
+    R get() {
+        wait<WaitPolitic>();
+
+        if constexpr(!std::is_void_v<R>) {
+            return m_runnable->template getResult<R>();
+        }
+
+        else if(isCancelled()) {
+            throw std::runtime_error{"The runnable was cancelled"};
+        }
+    }
+
+    /**
+     * Wait for the runnable and access its result where it was constructed, without moving it
+     * @return U& - The result of the runnable, owned by the runnable
+     */
+    template<typename WaitPolitic = default_wait_politic, typename U = R>
+    U &getReference() {
+        static_assert(!std::is_void_v<U>, "The runnable does not return anything");
+        wait<WaitPolitic>();
+        return m_runnable->template getResultReference<U>();
+    }
+
+    /**
+     * Register a continuation without lock
+     *
+     * The continuation is launched by the worker that finishes this runnable, just after it.
+     * If this runnable is already finished, the continuation is launched at once by the calling thread.
+     * If this runnable is cancelled, the continuation is cancelled too.
+     * @param f - A noexcept function that takes R& (or nothing if R is void)
+     * @return The handle of the continuation
+     */
+    template<typename F>
+    auto then(F f) {
+        if constexpr(std::is_void_v<R>) {
+            static_assert(noexcept(std::declval<F&>()()), "The continuation must be noexcept");
+        }
+
+        else {
+            static_assert(noexcept(std::declval<F&>()(std::declval<R&>())), "The continuation must be noexcept");
+        }
+
+        auto runnable = m_runnable;
+        auto continuation = [runnable, f = std::move(f)]() mutable noexcept {
+            if constexpr(std::is_void_v<R>) {
+                (void)runnable;
+                return f();
+            }
+
+            else {
+                return f(runnable->template getResultReference<R>());
+            }
+        };
+
+        using U = decltype(continuation());
+
+        auto node = new detail::ContinuationRunnable{std::move(continuation)};
+        TaskHandle<U, Runnable<>> handle{&node->m_runnable};
+        m_runnable->addContinuation(node);
+        return handle;
+    }
+
+private:
+    RunnableType *m_runnable;
+};
+
+template<typename R, typename RunnableType = Runnable<>>
+using Future = TaskHandle<R, RunnableType>;
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include <atomic>
+#include "Metrics.h"
+#include "CacheLine.h"
+
+namespace man {
+/**
+ * Base class of the nodes stored inside an InjectionQueue
+ */
+struct QueueNode {
+    std::atomic<QueueNode*> m_nextInQueue{nullptr};
+};
+
+/**
+ * Intrusive queue of T, which must derive from QueueNode.
+ *
+ * It is the intrusive multi producers queue of Dmitry Vyukov :
+ * push is wait-free and may be called by any thread.
+ * The consumers take turns with a try-lock, so tryPop never blocks :
+ * it returns nullptr if the queue is empty or if another consumer is popping.
+ */
+template<typename T>
+class InjectionQueue {
+public:
+    InjectionQueue() noexcept = default;
+    InjectionQueue(const InjectionQueue&) = delete;
+    InjectionQueue &operator=(const InjectionQueue&) = delete;
+
+    void push(T *node) noexcept {
+        pushNode(node);
+    }
+
+    /**
+     * Push the nodes from first to last, which must already be linked
+     * through m_nextInQueue, with only one atomic exchange
+     */
+    void pushChain(T *first, T *last) noexcept {
+        last->m_nextInQueue.store(nullptr, std::memory_order_relaxed);
+        auto previous = m_back.exchange(last, std::memory_order_acq_rel);
+        previous->m_nextInQueue.store(first, std::memory_order_release);
+    }
+
+    T *tryPop() noexcept {
+        if(isEmpty()) {
+            return nullptr;
+        }
+
+        if(m_isPopping.exchange(true, std::memory_order_acquire)) {
+            MAN_METRIC_ADD(m_failedLocks, 1);
+            return nullptr;
+        }
+
+        auto node = popNode();
+        m_isPopping.store(false, std::memory_order_release);
+        return static_cast<T*>(node);
+    }
+
+    /**
+     * Pop at most maximum nodes while taking the consumer lock only once,
+     * and call f on each one
+     * @return The number of popped nodes
+     */
+    template<typename F>
+    std::size_t tryPopMany(std::size_t maximum, F &&f) noexcept {
+        if(isEmpty()) {
+            return 0;
+        }
+
+        if(m_isPopping.exchange(true, std::memory_order_acquire)) {
+            MAN_METRIC_ADD(m_failedLocks, 1);
+            return 0;
+        }
+
+        std::size_t numberOfNodes{0};
+        for(; numberOfNodes < maximum; ++numberOfNodes) {
+            auto node = popNode();
+
+            if(node == nullptr) {
+                break;
+            }
+
+            f(static_cast<T*>(node));
+        }
+
+        m_isPopping.store(false, std::memory_order_release);
+        return numberOfNodes;
+    }
+
+    /**
+     * The result is only a hint when other threads are working on the queue
+     */
+    bool isEmpty() const noexcept {
+        return m_back.load(std::memory_order_relaxed) == &m_stub;
+    }
+
+private:
+    void pushNode(QueueNode *node) noexcept {
+        node->m_nextInQueue.store(nullptr, std::memory_order_relaxed);
+        auto previous = m_back.exchange(node, std::memory_order_acq_rel);
+        previous->m_nextInQueue.store(node, std::memory_order_release);
+    }
+
+    QueueNode *popNode() noexcept {
+        auto front = m_front;
+        auto next = front->m_nextInQueue.load(std::memory_order_acquire);
+
+        if(front == &m_stub) {
+            if(next == nullptr) {
+                return nullptr;
+            }
+
+            m_front = next;
+            front = next;
+            next = next->m_nextInQueue.load(std::memory_order_acquire);
+        }
+
+        if(next != nullptr) {
+            m_front = next;
+            return front;
+        }
+
+        if(front != m_back.load(std::memory_order_acquire)) {
+            // A producer is between its exchange and its store
+            return nullptr;
+        }
+
+        pushNode(&m_stub);
+        next = front->m_nextInQueue.load(std::memory_order_acquire);
+
+        if(next != nullptr) {
+            m_front = next;
+            return front;
+        }
+
+        return nullptr;
+    }
+
+private:
+    QueueNode m_stub;
+    // The producers write m_back, the consumer writes m_front
+    alignas(cacheLineSize) std::atomic<QueueNode*> m_back{&m_stub};
+    alignas(cacheLineSize) QueueNode *m_front{&m_stub};
+    std::atomic<bool> m_isPopping{false};
+};
+}
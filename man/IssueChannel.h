@@ -0,0 +1,190 @@
+#pragma once
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <string_view>
+#include "Concept.h"
+#include "CacheLine.h"
+
+/**
+ * The number of characters kept from the message of a reported issue
+ */
+#ifndef MAN_ISSUE_MESSAGE_SIZE
+#define MAN_ISSUE_MESSAGE_SIZE 48
+#endif
+
+/**
+ * The number of issues a worker keeps until they are consumed, it must be a power of two
+ */
+#ifndef MAN_ISSUE_RING_SIZE
+#define MAN_ISSUE_RING_SIZE 128
+#endif
+
+namespace man {
+/**
+ * An issue reported without allocation, its message is truncated to MAN_ISSUE_MESSAGE_SIZE characters
+ */
+struct IssueRecord {
+    static_assert(MAN_ISSUE_MESSAGE_SIZE <= 255, "The size of a message must fit in one byte");
+
+    std::string_view message() const noexcept {
+        return std::string_view{m_message, m_size};
+    }
+
+    /**
+     * Copy the record into an Issue, which allocates its message
+     */
+    Issue toIssue() const {
+        return Issue{std::string{message()}, m_kind};
+    }
+
+    char m_message[MAN_ISSUE_MESSAGE_SIZE];
+    std::uint8_t m_size;
+    KindOfError m_kind;
+    // The worker which ran the task
+    std::uint32_t m_worker;
+};
+
+/**
+ * Ring of issues written by one worker and read by one consumer, without lock nor allocation.
+ *
+ * When it is full, the new issues are dropped and counted
+ */
+class IssueRing {
+    static constexpr std::size_t capacity = MAN_ISSUE_RING_SIZE;
+    static_assert((capacity & (capacity - 1)) == 0, "MAN_ISSUE_RING_SIZE must be a power of two");
+
+public:
+    /**
+     * Must only be called by the producer
+     * @return false if the ring is full
+     */
+    bool push(std::string_view message, KindOfError kind, std::uint32_t worker) noexcept {
+        auto tail = m_tail.load(std::memory_order_relaxed);
+
+        if(tail - m_head.load(std::memory_order_acquire) == capacity) {
+            m_numberOfDroppedIssues.store(m_numberOfDroppedIssues.load(std::memory_order_relaxed) + 1,
+                                          std::memory_order_relaxed);
+            return false;
+        }
+
+        auto &record = m_records[tail & (capacity - 1)];
+        record.m_size = static_cast<std::uint8_t>(std::min<std::size_t>(message.size(), MAN_ISSUE_MESSAGE_SIZE));
+        std::memcpy(record.m_message, message.data(), record.m_size);
+        record.m_kind = kind;
+        record.m_worker = worker;
+
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Give each available record to f, then release them. Must only be called by the consumer
+     * @return The number of consumed records
+     */
+    template<typename F>
+    std::size_t consume(F &&f) {
+        auto head = m_head.load(std::memory_order_relaxed);
+        auto tail = m_tail.load(std::memory_order_acquire);
+
+        for(auto index = head; index != tail; ++index) {
+            f(static_cast<const IssueRecord&>(m_records[index & (capacity - 1)]));
+        }
+
+        m_head.store(tail, std::memory_order_release);
+        return tail - head;
+    }
+
+    std::uint64_t getNumberOfDroppedIssues() const noexcept {
+        return m_numberOfDroppedIssues.load(std::memory_order_relaxed);
+    }
+
+private:
+    alignas(cacheLineSize) std::atomic<std::size_t> m_head{0};
+    alignas(cacheLineSize) std::atomic<std::size_t> m_tail{0};
+    std::atomic<std::uint64_t> m_numberOfDroppedIssues{0};
+    IssueRecord m_records[capacity];
+};
+
+/**
+ * The issues reported by the tasks of a thread pool, one ring by worker.
+ *
+ * The rings are allocated once with the channel : reporting an issue and consuming it
+ * never allocates. The consumers take turns, the workers never wait for them
+ */
+class IssueChannel {
+public:
+    explicit IssueChannel(std::size_t numberOfWorkers) : m_rings(numberOfWorkers) {}
+
+    /**
+     * Make reportIssue write into the ring of worker on the calling thread
+     */
+    void attachCurrentThread(std::size_t worker) noexcept {
+        currentProducer() = Producer{&m_rings[worker], static_cast<std::uint32_t>(worker)};
+    }
+
+    /**
+     * Give each reported issue to f, in the order of the workers
+     * @return The number of consumed issues
+     */
+    template<typename F>
+    std::size_t consume(F &&f) {
+        std::scoped_lock lock{m_consumerMutex};
+        std::size_t count{0};
+
+        for(auto &ring : m_rings) {
+            count += ring.consume(f);
+        }
+
+        return count;
+    }
+
+    /**
+     * The number of issues lost because the ring of their worker was full
+     */
+    std::uint64_t getNumberOfDroppedIssues() const noexcept {
+        std::uint64_t count{0};
+
+        for(auto &ring : m_rings) {
+            count += ring.getNumberOfDroppedIssues();
+        }
+
+        return count;
+    }
+
+    /**
+     * Report an issue from a task, without allocation
+     * @return false if the calling thread is not a worker, or if its ring is full
+     */
+    static bool report(std::string_view message, KindOfError kind) noexcept {
+        auto &producer = currentProducer();
+        return producer.m_ring != nullptr && producer.m_ring->push(message, kind, producer.m_worker);
+    }
+
+private:
+    struct Producer {
+        IssueRing *m_ring;
+        std::uint32_t m_worker;
+    };
+
+    static Producer &currentProducer() noexcept {
+        static thread_local Producer producer{nullptr, 0};
+        return producer;
+    }
+
+private:
+    std::vector<IssueRing> m_rings;
+    std::mutex m_consumerMutex;
+};
+
+/**
+ * Report an issue from the task running on the current worker
+ * @return false if the issue is dropped
+ */
+inline bool reportIssue(std::string_view message, KindOfError kind = KindOfError::INFORMATION) noexcept {
+    return IssueChannel::report(message, kind);
+}
+}
@@ -0,0 +1,177 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include "CacheLine.h"
+
+/**
+ * The thread pools count what their workers do only if MAN_ENABLE_METRICS is 1.
+ * Otherwise the counters are compiled out and cost nothing.
+ */
+#ifndef MAN_ENABLE_METRICS
+#define MAN_ENABLE_METRICS 0
+#endif
+
+#if MAN_ENABLE_METRICS
+#define MAN_METRIC_ADD(counter, value) ::man::detail::addToMetric(&::man::WorkerMetrics::counter, (value))
+#define MAN_METRIC_SCOPE(counter) ::man::detail::MetricTimer metricTimer{&::man::WorkerMetrics::counter}
+#define MAN_METRICS_OF(metrics) ::man::detail::MetricsScope metricsScope{metrics}
+#else
+#define MAN_METRIC_ADD(counter, value) ((void)0)
+#define MAN_METRIC_SCOPE(counter) ((void)0)
+#define MAN_METRICS_OF(metrics) ((void)0)
+#endif
+
+namespace man {
+/**
+ * The counters of one worker.
+ *
+ * Only its worker writes them, so they are increased without any atomic
+ * read-modify-write, and each worker has its own cache line.
+ */
+struct alignas(cacheLineSize) WorkerMetrics {
+    std::atomic<std::uint64_t> m_executedTasks{0};
+    std::atomic<std::uint64_t> m_stolenTasks{0};
+    std::atomic<std::uint64_t> m_failedLocks{0};
+    std::atomic<std::uint64_t> m_idleRounds{0};
+    std::atomic<std::uint64_t> m_idleTime{0};
+    std::atomic<std::uint64_t> m_executionTime{0};
+};
+
+/**
+ * The counters of one worker at one time
+ */
+struct WorkerMetricsSnapshot {
+    std::uint64_t m_executedTasks{0};
+    std::uint64_t m_stolenTasks{0};
+    std::uint64_t m_failedLocks{0};
+    // The number of times the worker did not find anything to do
+    std::uint64_t m_idleRounds{0};
+    // The time spent spinning, yielding or parked
+    std::chrono::nanoseconds m_idleTime{0};
+    std::chrono::nanoseconds m_executionTime{0};
+    // The number of runnables waiting in the queue of the worker
+    std::size_t m_queueDepth{0};
+
+    WorkerMetricsSnapshot &operator+=(const WorkerMetricsSnapshot &other) noexcept {
+        m_executedTasks += other.m_executedTasks;
+        m_stolenTasks += other.m_stolenTasks;
+        m_failedLocks += other.m_failedLocks;
+        m_idleRounds += other.m_idleRounds;
+        m_idleTime += other.m_idleTime;
+        m_executionTime += other.m_executionTime;
+        m_queueDepth += other.m_queueDepth;
+        return *this;
+    }
+};
+
+struct MetricsSnapshot {
+    std::vector<WorkerMetricsSnapshot> m_workers;
+
+    WorkerMetricsSnapshot total() const noexcept {
+        WorkerMetricsSnapshot total;
+        for(auto &worker : m_workers) {
+            total += worker;
+        }
+        return total;
+    }
+};
+
+/**
+ * Read the counters of a worker while it keeps running
+ */
+inline WorkerMetricsSnapshot takeSnapshot(const WorkerMetrics &metrics, std::size_t queueDepth) noexcept {
+    WorkerMetricsSnapshot snapshot;
+    snapshot.m_executedTasks = metrics.m_executedTasks.load(std::memory_order_relaxed);
+    snapshot.m_stolenTasks = metrics.m_stolenTasks.load(std::memory_order_relaxed);
+    snapshot.m_failedLocks = metrics.m_failedLocks.load(std::memory_order_relaxed);
+    snapshot.m_idleRounds = metrics.m_idleRounds.load(std::memory_order_relaxed);
+    snapshot.m_idleTime = std::chrono::nanoseconds{metrics.m_idleTime.load(std::memory_order_relaxed)};
+    snapshot.m_executionTime = std::chrono::nanoseconds{metrics.m_executionTime.load(std::memory_order_relaxed)};
+    snapshot.m_queueDepth = queueDepth;
+    return snapshot;
+}
+
+namespace detail {
+/**
+ * The metrics of the worker running on the current thread, nullptr if it is not a worker
+ * of the pool it is working for
+ */
+inline WorkerMetrics *&currentWorkerMetrics() noexcept {
+    static thread_local WorkerMetrics *metrics{nullptr};
+    return metrics;
+}
+
+/**
+ * Give the current thread the metrics it has in a pool, during its scope.
+ *
+ * A worker of a pool which submits to another pool must not count in its own metrics
+ * what it does inside the other one
+ */
+class MetricsScope {
+public:
+    explicit MetricsScope(WorkerMetrics *metrics) noexcept :
+        m_previous{std::exchange(currentWorkerMetrics(), metrics)} {}
+
+    MetricsScope(const MetricsScope &) = delete;
+    MetricsScope &operator=(const MetricsScope &) = delete;
+
+    ~MetricsScope() noexcept {
+        currentWorkerMetrics() = m_previous;
+    }
+
+private:
+    WorkerMetrics *m_previous;
+};
+
+/**
+ * The number of MetricTimer alive on the current thread
+ */
+inline std::size_t &metricTimerDepth() noexcept {
+    static thread_local std::size_t depth{0};
+    return depth;
+}
+
+inline void addToMetric(std::atomic<std::uint64_t> WorkerMetrics::*counter, std::uint64_t value) noexcept {
+    if(auto metrics = currentWorkerMetrics(); metrics != nullptr) {
+        auto &atomic = metrics->*counter;
+        atomic.store(atomic.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Add the time spent in its scope to a counter.
+ *
+ * Only the outermost timer of a thread counts : a task which runs other tasks while it waits
+ * for them, through runPendingRunnable, already counts their time
+ */
+class MetricTimer {
+public:
+    explicit MetricTimer(std::atomic<std::uint64_t> WorkerMetrics::*counter) noexcept :
+        m_counter{counter}, m_isOutermost{metricTimerDepth()++ == 0} {
+        if(m_isOutermost) {
+            m_start = std::chrono::steady_clock::now();
+        }
+    }
+
+    MetricTimer(const MetricTimer &) = delete;
+    MetricTimer &operator=(const MetricTimer &) = delete;
+
+    ~MetricTimer() noexcept {
+        --metricTimerDepth();
+
+        if(m_isOutermost) {
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start);
+            addToMetric(m_counter, static_cast<std::uint64_t>(elapsed.count()));
+        }
+    }
+
+private:
+    std::atomic<std::uint64_t> WorkerMetrics::*m_counter;
+    bool m_isOutermost;
+    std::chrono::steady_clock::time_point m_start;
+};
+}
+}
@@ -1,10 +1,72 @@
 #pragma once
 #include "Concept.h"
 #include "Trait.h"
+#include <new>
+#include <memory>
+#include <cassert>
+#include <type_traits>
 
 namespace man {
+namespace detail {
+/**
+ * Storage of a result, which is constructed only when the task returns it
+ *
+ * The result is constructed in place from the call, so it is neither default
+ * constructed nor moved
+ */
+template<typename T>
+class LazyResult {
+public:
+    LazyResult() noexcept = default;
+
+    LazyResult(LazyResult &&other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if(other.m_hasValue) {
+            emplace([&other]() -> T {return std::move(*other);});
+        }
+    }
+
+    LazyResult &operator=(LazyResult &&) = delete;
+
+    ~LazyResult() noexcept {
+        reset();
+    }
+
+    /**
+     * Destroy the previous result, and construct the new one from the value returned by f
+     */
+    template<typename F>
+    void emplace(F &&f) {
+        reset();
+        new (m_storage) T(std::forward<F>(f)());
+        m_hasValue = true;
+    }
+
+    void reset() noexcept {
+        if(m_hasValue) {
+            (**this).~T();
+            m_hasValue = false;
+        }
+    }
+
+    T &operator*() noexcept {
+        assert(m_hasValue && "The result is not constructed");
+        return *std::launder(reinterpret_cast<T*>(m_storage));
+    }
+
+private:
+    alignas(T) unsigned char m_storage[sizeof(T)];
+    bool m_hasValue{false};
+};
+}
+
+namespace detail {
+/**
+ * A task and its result, called without any virtual dispatch.
+ *
+ * Model adds the type erasure of Concept on top of it, TypedRunnable stores it as it is
+ */
 template<typename T, typename ...Args>
-struct Model : Concept<Args...> {
+struct TaskModel {
 
     /**
      * The nothing type is used because it is not possible to create
@@ -33,25 +95,31 @@ struct Model : Concept<Args...> {
     static_assert(isNoexcept);
 
     template<typename _T>
-    Model(_T data) :
-        Concept<Args...>{typeid(ReturnType)}, m_data(data){}
+    TaskModel(_T data) : m_data(std::move(data)){}
 
-    void launch(Args... args) noexcept override {
+    void launch(Args... args) noexcept {
         if constexpr(isNoReturn) {
             m_data(std::forward<Args>(args)...);
         }
 
         else {
-            m_result = m_data(std::forward<Args>(args)...);
+            m_result.emplace([&]() -> ReturnType {
+                return m_data(std::forward<Args>(args)...);
+            });
         }
     }
 
-    void retrieveResult(void *p) noexcept override {
-        auto &value = *static_cast<ReturnType*>(p);
-        value = std::move(m_result);
-    };
+    void *resultAddress() noexcept {
+        if constexpr(isNoReturn) {
+            return nullptr;
+        }
 
-    std::optional<Progression> progression() const noexcept override {
+        else {
+            return std::addressof(*m_result);
+        }
+    }
+
+    std::optional<Progression> progression() const noexcept {
         if constexpr(hasProgression) {
             return getProgression(m_data);
         }
@@ -59,7 +127,7 @@ struct Model : Concept<Args...> {
         return {};
     }
 
-    std::vector<Issue> issues() const noexcept override {
+    std::vector<Issue> issues() const noexcept {
         if constexpr(hasIssues) {
             return getIssues(m_data);
         }
@@ -68,6 +136,37 @@ struct Model : Concept<Args...> {
     }
 
     T m_data;
-    ReturnType m_result;
+    LazyResult<ReturnType> m_result;
+};
+}
+
+template<typename T, typename ...Args>
+struct Model final : Concept<Args...>, detail::TaskModel<T, Args...> {
+    using TaskModelType = detail::TaskModel<T, Args...>;
+    using typename TaskModelType::ReturnType;
+
+    template<typename _T>
+    Model(_T data) :
+        Concept<Args...>{typeid(ReturnType)}, TaskModelType(std::move(data)){}
+
+    Concept<Args...> *moveTo(void *buffer) noexcept override {
+        return new (buffer) Model{std::move(*this)};
+    }
+
+    void launch(Args... args) noexcept override {
+        TaskModelType::launch(std::forward<Args>(args)...);
+    }
+
+    void *resultAddress() noexcept override {
+        return TaskModelType::resultAddress();
+    }
+
+    std::optional<Progression> progression() const noexcept override {
+        return TaskModelType::progression();
+    }
+
+    std::vector<Issue> issues() const noexcept override {
+        return TaskModelType::issues();
+    }
 };
 }
@@ -0,0 +1,300 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cassert>
+#include <algorithm>
+#include <type_traits>
+#include "Channel.h"
+#include "WaitPolitic.h"
+
+namespace man {
+enum class StageMode {
+    // One batch at a time, the items are processed and given to the next stage in the order they reach the stage
+    SERIAL,
+    // As many batches at a time as the pool has workers, the items may be reordered
+    PARALLEL
+};
+
+namespace detail {
+/**
+ * What the stages of a pipeline share : the pool, the number of items in flight and its limit
+ */
+template<typename Pool>
+struct PipelineCore {
+    PipelineCore(Pool &pool, std::size_t maximumNumberOfItems, std::size_t batchSize) noexcept :
+        m_pool{pool},
+        m_maximumNumberOfItems{std::max<std::size_t>(maximumNumberOfItems, 1)},
+        m_batchSize{std::max<std::size_t>(batchSize, 1)} {}
+
+    void onItemFinished() noexcept {
+        auto numberOfItems = m_numberOfItems.fetch_sub(1, std::memory_order_acq_rel);
+
+        // Wake up the producer stalled by the limit, or the thread waiting for the end
+        if(numberOfItems == m_maximumNumberOfItems || numberOfItems == 1) {
+            notifyWaiters(m_numberOfItems);
+        }
+    }
+
+    void onTaskFinished() noexcept {
+        // The pipeline may be destroyed as soon as the last task is counted
+        m_numberOfTasks.finish();
+    }
+
+    Pool &m_pool;
+    std::size_t m_maximumNumberOfItems;
+    std::size_t m_batchSize;
+    std::atomic<std::size_t> m_numberOfItems{0};
+    CompletionCounter m_numberOfTasks;
+};
+
+struct StageBase {
+    virtual ~StageBase() noexcept = default;
+};
+
+template<typename T>
+struct StageInput : StageBase {
+    virtual void push(T &&item) noexcept = 0;
+};
+
+/**
+ * The core of a pipeline with its stages, which live as long as the pipeline
+ */
+template<typename Pool, typename In>
+struct PipelineHead : PipelineCore<Pool> {
+    using PipelineCore<Pool>::PipelineCore;
+
+    StageInput<In> *m_first{nullptr};
+    std::vector<std::unique_ptr<StageBase>> m_stages;
+};
+
+/**
+ * A stage takes its items from its channel by batches, in tasks it gives to the pool
+ * only while it has items : a stage without items does not hold any worker
+ */
+template<typename Pool, typename In, typename Out, typename F>
+class Stage final : public StageInput<In> {
+    struct DrainTask {
+        template<typename ...Contexts>
+        void operator()(Contexts &...) noexcept {
+            m_stage->drain();
+        }
+
+        Stage *m_stage;
+    };
+
+public:
+    Stage(PipelineCore<Pool> &core, StageMode mode, F function) :
+        m_core{core},
+        m_input{core.m_maximumNumberOfItems},
+        m_function{std::move(function)},
+        m_maximumNumberOfTasks{mode == StageMode::SERIAL ? 1 : core.m_pool.getMaximumNumberOfThreads()} {}
+
+    void push(In &&item) noexcept override {
+        // The number of items in flight is limited, so the channel is never full
+        [[maybe_unused]] auto isPushed = m_input.tryPush(std::move(item));
+        assert(isPushed);
+        scheduleIfNeeded();
+    }
+
+    StageInput<Out> *m_next{nullptr};
+
+private:
+    void scheduleIfNeeded() noexcept {
+        // Pairs with the fence of drain, so either a running task sees the item, or a new one is given
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto numberOfTasks = m_numberOfTasks.load(std::memory_order_relaxed);
+
+        while(numberOfTasks < m_maximumNumberOfTasks) {
+            if(m_numberOfTasks.compare_exchange_weak(numberOfTasks, numberOfTasks + 1, std::memory_order_relaxed)) {
+                m_core.m_numberOfTasks.add();
+                m_core.m_pool.addRunnableAndForget(DrainTask{this});
+                return;
+            }
+        }
+    }
+
+    void drain() noexcept {
+        for(std::size_t i{0}; i < m_core.m_batchSize; ++i) {
+            auto item = m_input.tryPop();
+
+            if(!item.has_value()) {
+                break;
+            }
+
+            if constexpr(std::is_void_v<Out>) {
+                m_function(std::move(*item));
+                m_core.onItemFinished();
+            }
+
+            else {
+                m_next->push(m_function(std::move(*item)));
+            }
+        }
+
+        // The remaining items go to another task, so the other stages get their turn
+        m_numberOfTasks.fetch_sub(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(!m_input.isEmpty()) {
+            scheduleIfNeeded();
+        }
+
+        m_core.onTaskFinished();
+    }
+
+private:
+    PipelineCore<Pool> &m_core;
+    Channel<In> m_input;
+    F m_function;
+    std::size_t m_maximumNumberOfTasks;
+    std::atomic<std::size_t> m_numberOfTasks{0};
+};
+}
+
+/**
+ * Stream of items of type In going through stages run by a pool.
+ *
+ * Each stage is a noexcept function which takes the item of the previous stage and returns
+ * the item of the next one, the last stage returns void. The stages are linked by bounded channels,
+ * and at most maximumNumberOfItems items are in flight : push waits while the pipeline is full,
+ * so a slow stage stalls the producer instead of growing memory. The stages themselves never wait,
+ * the items a slow stage did not process yet stay in its channel.
+ *
+ * Items pushed by one thread go out in the order they were pushed as long as every stage is SERIAL.
+ * A PARALLEL stage may reorder them, a SERIAL stage after it keeps the order they reach it.
+ * The pool must have no Args, the stages do not take the contexts.
+ */
+template<typename Pool, typename In, typename Out = In>
+class Pipeline {
+    template<typename, typename, typename>
+    friend class Pipeline;
+
+    using Head = detail::PipelineHead<Pool, In>;
+
+    template<typename F>
+    using StageResult = decltype(std::declval<F&>()(std::declval<Out>()));
+
+public:
+    /**
+     * @param maximumNumberOfItems - The number of items in flight, the capacity of each channel
+     * @param batchSize - The number of items a stage processes in one task
+     */
+    Pipeline(Pool &pool, std::size_t maximumNumberOfItems, std::size_t batchSize = 16) :
+        m_head{std::make_unique<Head>(pool, maximumNumberOfItems, batchSize)},
+        m_last{&m_head->m_first} {
+        static_assert(std::is_same_v<In, Out>);
+    }
+
+    Pipeline(Pipeline &&) noexcept = default;
+    Pipeline(const Pipeline &) = delete;
+    Pipeline &operator=(const Pipeline &) = delete;
+
+    ~Pipeline() noexcept {
+        assert((m_head == nullptr || !isRunning()) && "The pipeline must be finished before it is destroyed");
+    }
+
+    /**
+     * Add a stage after the last one
+     * @return The pipeline, whose items now go through the stage
+     */
+    template<typename F>
+    Pipeline<Pool, In, StageResult<F>> addStage(StageMode mode, F function) && {
+        static_assert(!std::is_void_v<Out>, "The last stage returns void, no stage may follow it");
+        static_assert(noexcept(std::declval<F&>()(std::declval<Out>())), "A stage must be noexcept");
+        assert(!isRunning());
+
+        auto stage = std::make_unique<detail::Stage<Pool, Out, StageResult<F>, F>>(*m_head, mode, std::move(function));
+        auto next = &stage->m_next;
+        *m_last = stage.get();
+        m_head->m_stages.push_back(std::move(stage));
+
+        return Pipeline<Pool, In, StageResult<F>>{std::move(m_head), next};
+    }
+
+    /**
+     * Give an item to the first stage, waiting as WaitPolitic tells while the pipeline is full.
+     *
+     * It must not be called by a worker of the pool
+     */
+    template<typename WaitPolitic = default_wait_politic>
+    void push(In item) noexcept {
+        static_assert(std::is_void_v<Out>, "The last stage must return void");
+
+        for(auto numberOfItems = m_head->m_numberOfItems.load(std::memory_order_acquire);;) {
+            if(numberOfItems == m_head->m_maximumNumberOfItems) {
+                WaitPolitic::waitWhileEqual(m_head->m_numberOfItems, numberOfItems);
+                numberOfItems = m_head->m_numberOfItems.load(std::memory_order_acquire);
+            }
+
+            else if(m_head->m_numberOfItems.compare_exchange_weak(numberOfItems, numberOfItems + 1,
+                                                                  std::memory_order_acq_rel)) {
+                break;
+            }
+        }
+
+        m_head->m_first->push(std::move(item));
+    }
+
+    /**
+     * Give an item to the first stage if the pipeline is not full
+     * @return false if it is full, item is not moved then
+     */
+    bool tryPush(In &&item) noexcept {
+        static_assert(std::is_void_v<Out>, "The last stage must return void");
+        auto numberOfItems = m_head->m_numberOfItems.load(std::memory_order_acquire);
+
+        do {
+            if(numberOfItems == m_head->m_maximumNumberOfItems) {
+                return false;
+            }
+        } while(!m_head->m_numberOfItems.compare_exchange_weak(numberOfItems, numberOfItems + 1,
+                                                               std::memory_order_acq_rel));
+
+        m_head->m_first->push(std::move(item));
+        return true;
+    }
+
+    /**
+     * Wait until every pushed item went through the last stage
+     */
+    template<typename WaitPolitic = default_wait_politic>
+    void wait() const noexcept {
+        for(auto numberOfItems = m_head->m_numberOfItems.load(std::memory_order_acquire); numberOfItems != 0;
+            numberOfItems = m_head->m_numberOfItems.load(std::memory_order_acquire)) {
+            WaitPolitic::waitWhileEqual(m_head->m_numberOfItems, numberOfItems);
+        }
+
+        // The last tasks may still be leaving their stage
+        m_head->m_numberOfTasks.template wait<WaitPolitic>();
+    }
+
+    bool isRunning() const noexcept {
+        return m_head->m_numberOfItems.load(std::memory_order_acquire) != 0 ||
+               !m_head->m_numberOfTasks.isFinished();
+    }
+
+    /**
+     * The number of items pushed which did not go through the last stage yet
+     */
+    std::size_t getNumberOfItems() const noexcept {
+        return m_head->m_numberOfItems.load(std::memory_order_relaxed);
+    }
+
+private:
+    Pipeline(std::unique_ptr<Head> head, detail::StageInput<Out> **last) noexcept :
+        m_head{std::move(head)}, m_last{last} {}
+
+private:
+    std::unique_ptr<Head> m_head;
+    // Where the stage added next is linked
+    detail::StageInput<Out> **m_last;
+};
+
+/**
+ * Build a pipeline without any stage, whose items are of type In
+ */
+template<typename In, typename Pool>
+Pipeline<Pool, In> makePipeline(Pool &pool, std::size_t maximumNumberOfItems, std::size_t batchSize = 16) {
+    return Pipeline<Pool, In>{pool, maximumNumberOfItems, batchSize};
+}
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
+#include "RangeType.h"
+#include "CacheLine.h"
+
+namespace man {
+/**
+ * The progression of a group of tasks, as units of work completed over units of work added.
+ *
+ * The tasks complete their units themselves, so reading the progression of the whole group
+ * costs two loads instead of one getProgression by task
+ */
+template<typename T, typename ErrorPolitic>
+class ProgressAggregateTemplated {
+public:
+    explicit ProgressAggregateTemplated(std::uint64_t numberOfUnits = 0) noexcept :
+        m_numberOfUnits{numberOfUnits} {}
+
+    ProgressAggregateTemplated(const ProgressAggregateTemplated &) = delete;
+    ProgressAggregateTemplated &operator=(const ProgressAggregateTemplated &) = delete;
+
+    /**
+     * Add units of work to the group, before or while it runs
+     */
+    void addUnits(std::uint64_t numberOfUnits) noexcept {
+        m_numberOfUnits.fetch_add(numberOfUnits, std::memory_order_relaxed);
+    }
+
+    /**
+     * Called by a task each time it completes units of work, better by batches than one by one
+     */
+    void complete(std::uint64_t numberOfUnits = 1) noexcept {
+        m_numberOfCompletedUnits.fetch_add(numberOfUnits, std::memory_order_relaxed);
+    }
+
+    std::uint64_t getNumberOfUnits() const noexcept {
+        return m_numberOfUnits.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t getNumberOfCompletedUnits() const noexcept {
+        return m_numberOfCompletedUnits.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * A group without any unit is complete
+     */
+    ProgressionTemplated<T, ErrorPolitic> progression() const noexcept(ProgressionTemplated<T, ErrorPolitic>::isNoexcept) {
+        auto numberOfUnits = getNumberOfUnits();
+
+        if(numberOfUnits == 0) {
+            return ProgressionTemplated<T, ErrorPolitic>{T{1}};
+        }
+
+        auto numberOfCompletedUnits = std::min(getNumberOfCompletedUnits(), numberOfUnits);
+        return ProgressionTemplated<T, ErrorPolitic>{static_cast<T>(numberOfCompletedUnits) / static_cast<T>(numberOfUnits)};
+    }
+
+private:
+    alignas(cacheLineSize) std::atomic<std::uint64_t> m_numberOfCompletedUnits{0};
+    alignas(cacheLineSize) std::atomic<std::uint64_t> m_numberOfUnits;
+};
+
+using ProgressAggregate = ProgressAggregateTemplated<float, assert_politic>;
+}
@@ -0,0 +1,594 @@
+#pragma once
+#include <random>
+#include <algorithm>
+#include <array>
+#include <queue>
+#include <chrono>
+#include "Chrono.h"
+#include "Trait.h"
+#include "Topology.h"
+#include "RunnableQueue.h"
+#include "WorkStealingDeque.h"
+
+namespace man {
+struct queue_politic_tag{};
+
+enum class Priority {
+    BACKGROUND,
+    NORMAL,
+    INTERACTIVE
+};
+
+/**
+ * What a submission tells the scheduler about its urgency : a priority,
+ * and maybe an absolute deadline.
+ *
+ * The deadline is read on steady_clock, so changing the time of the system does not reorder
+ * the runnables. Only the priority_queue_politic uses it
+ */
+struct SchedulingHint {
+    using clock = std::chrono::steady_clock;
+
+    SchedulingHint(Priority priority = Priority::NORMAL) noexcept : m_priority{priority} {}
+    SchedulingHint(clock::time_point deadline, Priority priority = Priority::NORMAL) noexcept :
+        m_priority{priority}, m_deadline{deadline} {}
+
+    Priority m_priority{Priority::NORMAL};
+    clock::time_point m_deadline{clock::time_point::max()};
+};
+
+namespace detail {
+/**
+ * Split count values in numberOfChunks contiguous chunks of nearly the same size
+ * and call f(chunk, first, last) for each one
+ */
+template<typename T, typename F>
+void forEachChunk(T *values, std::size_t count, std::size_t numberOfChunks, F &&f) {
+    for(std::size_t chunk{0}; chunk < numberOfChunks; ++chunk) {
+        f(chunk, values + count * chunk / numberOfChunks, values + count * (chunk + 1) / numberOfChunks);
+    }
+}
+}
+
+/**
+ * The other workers, sorted by their distance from one worker.
+ *
+ * The workers at the same distance are visited from a given start, so
+ * the thieves do not all fall on the same victim.
+ */
+class VictimOrder {
+public:
+    VictimOrder(std::size_t worker, std::size_t numberOfWorkers, const DistanceMatrix &distances) {
+        auto distanceTo = [&](std::size_t victim) {
+            return distances.empty() ? 0u : distances[worker][victim];
+        };
+
+        for(std::size_t victim{0}; victim < numberOfWorkers; ++victim) {
+            if(victim != worker) {
+                m_victims.push_back(victim);
+            }
+        }
+
+        std::stable_sort(m_victims.begin(), m_victims.end(), [&](std::size_t a, std::size_t b) {
+            return distanceTo(a) < distanceTo(b);
+        });
+
+        for(std::size_t i{0}; i < m_victims.size(); ++i) {
+            if(i + 1 == m_victims.size() || distanceTo(m_victims[i]) != distanceTo(m_victims[i + 1])) {
+                m_levelEnds.push_back(i + 1);
+            }
+        }
+    }
+
+    /**
+     * Call f on each victim, the nearest first, until it returns something else than nullptr
+     */
+    template<typename F>
+    auto find(std::size_t start, F &&f) const noexcept -> decltype(f(std::size_t{})) {
+        std::size_t levelBegin{0};
+
+        for(auto levelEnd : m_levelEnds) {
+            auto levelSize = levelEnd - levelBegin;
+
+            for(std::size_t i{0}; i < levelSize; ++i) {
+                if(auto result = f(m_victims[levelBegin + (start + i) % levelSize]); result != nullptr) {
+                    return result;
+                }
+            }
+
+            levelBegin = levelEnd;
+        }
+
+        return nullptr;
+    }
+
+private:
+    std::vector<std::size_t> m_victims;
+    std::vector<std::size_t> m_levelEnds;
+};
+
+template<typename Scheduler>
+using pushWithHintExpression = decltype(std::declval<Scheduler&>().push(nullptr, std::declval<const SchedulingHint&>()));
+
+/**
+ * Tells if the scheduler takes the SchedulingHint into account
+ */
+template<typename Scheduler>
+inline constexpr bool supports_scheduling_hint_v = is_valid_v<Scheduler, pushWithHintExpression>;
+
+/**
+ * Scheduler where each worker owns a RunnableQueue protected by a mutex.
+ *
+ * Workers try to lock every queue, starting from their own queue.
+ *
+ * A scheduler never blocks : pop returns nullptr when it does not find any runnable
+ * and the thread pool decides how to wait. hasWork tells the thread pool
+ * whether an idle worker may park.
+ */
+template<typename Queue>
+class MutexScheduler {
+public:
+    using RunnableAndArgs = typename Queue::RunnableAndArgs;
+
+    /**
+     * @param distances - The distances between the workers, empty if they are unknown
+     */
+    explicit MutexScheduler(std::size_t numberOfWorkers, const DistanceMatrix &distances = {}) :
+        m_queues{numberOfWorkers} {
+        for(std::size_t i{0}; i < numberOfWorkers; ++i) {
+            m_victimOrders.emplace_back(i, numberOfWorkers, distances);
+        }
+    }
+
+    bool isDone(std::size_t worker) const noexcept {
+        return m_queues[worker].isDone();
+    }
+
+    void push(RunnableAndArgs *runnable) noexcept {
+        auto index = m_numberOfPushes.fetch_add(1, std::memory_order_relaxed);
+
+        if(tryToPushToOneQueue(runnable)) {
+            return;
+        }
+
+        m_queues[index % m_queues.size()].push(runnable);
+    }
+
+    /**
+     * Split the runnables in contiguous chunks, one by queue, and lock each queue only once
+     */
+    void pushBulk(RunnableAndArgs *const *runnables, std::size_t count) noexcept {
+        auto numberOfChunks = std::min(count, m_queues.size());
+        auto firstQueue = m_numberOfPushes.fetch_add(numberOfChunks, std::memory_order_relaxed);
+
+        detail::forEachChunk(runnables, count, numberOfChunks, [&](std::size_t chunk, auto first, auto last) {
+            m_queues[(firstQueue + chunk) % m_queues.size()].pushBulk(first, last);
+        });
+    }
+
+    /**
+     * Push into the queue of worker, it must be called from this worker
+     */
+    void pushLocal(std::size_t worker, RunnableAndArgs *runnable) noexcept {
+        m_queues[worker].push(runnable);
+    }
+
+    RunnableAndArgs *pop(std::size_t worker) noexcept {
+        return tryToPopFromOneQueue(worker);
+    }
+
+    /**
+     * Pop from the queue of worker only, without stealing
+     */
+    RunnableAndArgs *popLocal(std::size_t worker) noexcept {
+        return m_queues[worker].pop(std::try_to_lock);
+    }
+
+    /**
+     * The number of runnables waiting in the queue of worker
+     */
+    std::size_t sizeOf(std::size_t worker) const noexcept {
+        return m_queues[worker].size();
+    }
+
+    bool hasWork() const noexcept {
+        return std::any_of(m_queues.begin(), m_queues.end(), [](const Queue &queue) {
+            return !queue.isEmpty();
+        });
+    }
+
+    void finish() noexcept {
+        for(auto &queue : m_queues) {
+            queue.finish();
+        }
+    }
+
+private:
+    /**
+     * Try the queue of worker, then the nearest queues first
+     */
+    RunnableAndArgs *tryToPopFromOneQueue(std::size_t worker) noexcept {
+        if(auto runnable = m_queues[worker].pop(std::try_to_lock); runnable != nullptr) {
+            return runnable;
+        }
+
+        return m_victimOrders[worker].find(worker, [this](std::size_t victim) {
+            auto runnable = m_queues[victim].pop(std::try_to_lock);
+            if(runnable != nullptr) {
+                MAN_METRIC_ADD(m_stolenTasks, 1);
+            }
+            return runnable;
+        });
+    }
+
+    bool tryToPushToOneQueue(RunnableAndArgs *runnablePtr) noexcept {
+        for(auto &queue : m_queues) {
+            if(queue.push(runnablePtr, std::try_to_lock)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+private:
+    std::vector<Queue> m_queues;
+    std::vector<VictimOrder> m_victimOrders;
+    std::atomic<std::size_t> m_numberOfPushes{0};
+};
+
+/**
+ * Scheduler where each worker owns a WorkStealingDeque.
+ *
+ * A worker pops its own deque in LIFO order, and steals in FIFO order
+ * from randomly chosen victims when its deque is empty.
+ * The submissions coming from outside of the pool are pushed into
+ * the inbox of one worker, which moves them into its deque.
+ */
+template<typename _RunnableAndArgs>
+class WorkStealingScheduler {
+public:
+    using RunnableAndArgs = _RunnableAndArgs;
+
+private:
+    struct alignas(cacheLineSize) Worker {
+        WorkStealingDeque<RunnableAndArgs> deque;
+        std::mutex inboxMutex;
+        std::vector<RunnableAndArgs*> inbox;
+        std::atomic<std::size_t> inboxSize{0};
+        std::minstd_rand random;
+    };
+
+public:
+    /**
+     * @param distances - The distances between the workers, empty if they are unknown
+     */
+    explicit WorkStealingScheduler(std::size_t numberOfWorkers, const DistanceMatrix &distances = {}) :
+        m_workers{numberOfWorkers} {
+        for(std::size_t i{0}; i < numberOfWorkers; ++i) {
+            m_workers[i].random.seed(static_cast<std::minstd_rand::result_type>(i + 1));
+            m_victimOrders.emplace_back(i, numberOfWorkers, distances);
+        }
+    }
+
+    bool isDone(std::size_t) const noexcept {
+        return m_done.load(std::memory_order_relaxed);
+    }
+
+    void push(RunnableAndArgs *runnable) noexcept {
+        auto index = m_numberOfPushes.fetch_add(1, std::memory_order_relaxed);
+        auto &worker = m_workers[index % m_workers.size()];
+
+        std::scoped_lock lock{worker.inboxMutex};
+        worker.inbox.emplace_back(runnable);
+        worker.inboxSize.store(worker.inbox.size(), std::memory_order_release);
+    }
+
+    /**
+     * Split the runnables in contiguous chunks, one by inbox, and lock each inbox only once
+     */
+    void pushBulk(RunnableAndArgs *const *runnables, std::size_t count) noexcept {
+        auto numberOfChunks = std::min(count, m_workers.size());
+        auto firstWorker = m_numberOfPushes.fetch_add(numberOfChunks, std::memory_order_relaxed);
+
+        detail::forEachChunk(runnables, count, numberOfChunks, [&](std::size_t chunk, auto first, auto last) {
+            auto &worker = m_workers[(firstWorker + chunk) % m_workers.size()];
+
+            std::scoped_lock lock{worker.inboxMutex};
+            worker.inbox.insert(worker.inbox.end(), first, last);
+            worker.inboxSize.store(worker.inbox.size(), std::memory_order_release);
+        });
+    }
+
+    /**
+     * Push into the deque of worker, it must be called from this worker
+     */
+    void pushLocal(std::size_t worker, RunnableAndArgs *runnable) noexcept {
+        m_workers[worker].deque.push(runnable);
+    }
+
+    RunnableAndArgs *pop(std::size_t index) noexcept {
+        auto &worker = m_workers[index];
+
+        if(auto runnable = worker.deque.pop(); runnable != nullptr) {
+            return runnable;
+        }
+
+        if(auto runnable = takeInbox(worker, worker); runnable != nullptr) {
+            return runnable;
+        }
+
+        return steal(index);
+    }
+
+    /**
+     * Pop from the deque and the inbox of worker only, without stealing.
+     * It must be called from this worker
+     */
+    RunnableAndArgs *popLocal(std::size_t index) noexcept {
+        auto &worker = m_workers[index];
+
+        if(auto runnable = worker.deque.pop(); runnable != nullptr) {
+            return runnable;
+        }
+
+        return takeInbox(worker, worker);
+    }
+
+    /**
+     * The number of runnables waiting in the deque and the inbox of worker
+     */
+    std::size_t sizeOf(std::size_t worker) const noexcept {
+        return m_workers[worker].deque.size() + m_workers[worker].inboxSize.load(std::memory_order_relaxed);
+    }
+
+    bool hasWork() const noexcept {
+        return std::any_of(m_workers.begin(), m_workers.end(), [](const Worker &worker) {
+            return !worker.deque.empty() || worker.inboxSize.load(std::memory_order_relaxed) != 0;
+        });
+    }
+
+    void finish() noexcept {
+        m_done.store(true, std::memory_order_relaxed);
+    }
+
+    ~WorkStealingScheduler() noexcept {
+        assert(std::all_of(m_workers.begin(), m_workers.end(), [](const Worker &worker) {
+            return worker.deque.empty() && worker.inbox.empty();
+        }));
+    }
+
+private:
+    /**
+     * Move all the inbox of owner into the deque of thief and return the last one
+     *
+     * thief must be the worker running on the current thread
+     */
+    RunnableAndArgs *takeInbox(Worker &owner, Worker &thief) noexcept {
+        if(owner.inboxSize.load(std::memory_order_acquire) == 0) {
+            return nullptr;
+        }
+
+        std::unique_lock lock{owner.inboxMutex, std::try_to_lock};
+
+        if(!lock) {
+            MAN_METRIC_ADD(m_failedLocks, 1);
+            return nullptr;
+        }
+
+        if(owner.inbox.empty()) {
+            return nullptr;
+        }
+
+        auto runnable = owner.inbox.back();
+        owner.inbox.pop_back();
+
+        // Oldest submissions are at the top of the deque so thieves take them first
+        for(auto other : owner.inbox) {
+            thief.deque.push(other);
+        }
+
+        owner.inbox.clear();
+        owner.inboxSize.store(0, std::memory_order_relaxed);
+        return runnable;
+    }
+
+    /**
+     * Try to steal from each other worker, the nearest first, starting from a random victim
+     */
+    RunnableAndArgs *steal(std::size_t thief) noexcept {
+        return m_victimOrders[thief].find(m_workers[thief].random(), [this, thief](std::size_t victimIndex) {
+            auto &victim = m_workers[victimIndex];
+
+            auto runnable = victim.deque.steal();
+            if(runnable == nullptr) {
+                runnable = takeInbox(victim, m_workers[thief]);
+            }
+
+            if(runnable != nullptr) {
+                MAN_METRIC_ADD(m_stolenTasks, 1);
+            }
+            return runnable;
+        });
+    }
+
+private:
+    std::vector<Worker> m_workers;
+    std::vector<VictimOrder> m_victimOrders;
+    std::atomic<std::size_t> m_numberOfPushes{0};
+    std::atomic<bool> m_done{false};
+};
+
+/**
+ * Scheduler shared by all the workers, with one queue by priority.
+ *
+ * Workers take the runnables of the highest priority first, and within a priority,
+ * the earliest deadline first, then the oldest submission first.
+ * To keep the low priorities moving, one pop out of FairnessPeriod takes, in turn,
+ * from each priority instead of the highest one.
+ */
+template<typename _RunnableAndArgs, std::size_t FairnessPeriod>
+class PriorityScheduler {
+public:
+    using RunnableAndArgs = _RunnableAndArgs;
+
+private:
+    static constexpr std::size_t numberOfPriorities = static_cast<std::size_t>(Priority::INTERACTIVE) + 1;
+
+    struct Entry {
+        SchedulingHint::clock::time_point deadline;
+        std::uint64_t sequence;
+        RunnableAndArgs *runnable;
+
+        bool operator<(const Entry &other) const noexcept {
+            // std::priority_queue gives the greatest entry first
+            return std::tie(other.deadline, other.sequence) < std::tie(deadline, sequence);
+        }
+    };
+
+public:
+    PriorityScheduler(std::size_t, const DistanceMatrix & = {}) noexcept {}
+
+    bool isDone(std::size_t) const noexcept {
+        return m_done.load(std::memory_order_relaxed);
+    }
+
+    void push(RunnableAndArgs *runnable, const SchedulingHint &hint = {}) noexcept {
+        std::scoped_lock lock{m_mutex};
+        queueOf(hint.m_priority).push(Entry{hint.m_deadline, m_sequence++, runnable});
+        m_size.store(m_size.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void pushBulk(RunnableAndArgs *const *runnables, std::size_t count) noexcept {
+        std::scoped_lock lock{m_mutex};
+        auto &queue = queueOf(Priority::NORMAL);
+
+        for(std::size_t i{0}; i < count; ++i) {
+            queue.push(Entry{SchedulingHint::clock::time_point::max(), m_sequence++, runnables[i]});
+        }
+        m_size.store(m_size.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    }
+
+    /**
+     * The queues are shared, so a local push is a normal push
+     */
+    void pushLocal(std::size_t, RunnableAndArgs *runnable) noexcept {
+        push(runnable);
+    }
+
+    RunnableAndArgs *pop(std::size_t) noexcept {
+        if(!hasWork()) {
+            return nullptr;
+        }
+
+        std::scoped_lock lock{m_mutex};
+
+        if(m_size.load(std::memory_order_relaxed) == 0) {
+            return nullptr;
+        }
+
+        auto &queue = chooseQueue();
+        auto runnable = queue.top().runnable;
+        queue.pop();
+        m_size.store(m_size.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+        return runnable;
+    }
+
+    /**
+     * The queues are shared, no worker has runnables of its own
+     */
+    RunnableAndArgs *popLocal(std::size_t) noexcept {
+        return nullptr;
+    }
+
+    /**
+     * The queues are shared, so they are reported as the ones of the first worker
+     */
+    std::size_t sizeOf(std::size_t worker) const noexcept {
+        return worker == 0 ? m_size.load(std::memory_order_relaxed) : 0;
+    }
+
+    bool hasWork() const noexcept {
+        return m_size.load(std::memory_order_relaxed) != 0;
+    }
+
+    void finish() noexcept {
+        m_done.store(true, std::memory_order_relaxed);
+    }
+
+    ~PriorityScheduler() noexcept {
+        assert(m_size.load(std::memory_order_relaxed) == 0);
+    }
+
+private:
+    using Queue = std::priority_queue<Entry>;
+
+    Queue &queueOf(Priority priority) noexcept {
+        return m_queues[static_cast<std::size_t>(priority)];
+    }
+
+    /**
+     * Must be called with the lock and at least one runnable
+     */
+    Queue &chooseQueue() noexcept {
+        if(++m_numberOfPops % FairnessPeriod == 0) {
+            auto &queue = m_queues[m_fairnessTurn++ % numberOfPriorities];
+
+            if(!queue.empty()) {
+                return queue;
+            }
+        }
+
+        for(auto priority = numberOfPriorities; priority-- > 0;) {
+            if(!m_queues[priority].empty()) {
+                return m_queues[priority];
+            }
+        }
+
+        assert(false && "chooseQueue is called without any runnable");
+        return m_queues[0];
+    }
+
+private:
+    std::mutex m_mutex;
+    std::array<Queue, numberOfPriorities> m_queues;
+    std::uint64_t m_sequence{0};
+    std::size_t m_numberOfPops{0};
+    std::size_t m_fairnessTurn{0};
+    std::atomic<std::size_t> m_size{0};
+    std::atomic<bool> m_done{false};
+};
+
+/**
+ * Politic that gives one mutex protected queue per worker
+ */
+struct mutex_queue_politic {
+    using politic_category = queue_politic_tag;
+
+    template<typename RunnableAndArgs>
+    using scheduler = MutexScheduler<RunnableQueue<RunnableAndArgs>>;
+};
+
+/**
+ * Politic that gives one lock-free work stealing deque per worker
+ */
+struct work_stealing_queue_politic {
+    using politic_category = queue_politic_tag;
+
+    template<typename RunnableAndArgs>
+    using scheduler = WorkStealingScheduler<RunnableAndArgs>;
+};
+
+/**
+ * Politic that runs the highest priority and the earliest deadline first, see PriorityScheduler.
+ *
+ * One pop out of FairnessPeriod serves the priorities in turn, so they can not starve
+ */
+template<std::size_t FairnessPeriod = 16>
+struct priority_queue_politic {
+    using politic_category = queue_politic_tag;
+
+    template<typename RunnableAndArgs>
+    using scheduler = PriorityScheduler<RunnableAndArgs, FairnessPeriod>;
+};
+}
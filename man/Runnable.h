@@ -1,143 +1,165 @@
 #pragma once
-#include <thread>
+#include <cstddef>
+#include <utility>
+#include <functional>
 #include "Model.h"
-#include "Chrono.h"
+#include "RunnableState.h"
+
+/**
+ * The size of the buffer used by a Runnable to store its task without allocation
+ */
+#ifndef MAN_RUNNABLE_INLINE_SIZE
+#define MAN_RUNNABLE_INLINE_SIZE 64
+#endif
 
 namespace man {
-template<typename ...Args>
-class Runnable {
-    template<typename ..._Args>
-    friend std::optional<Progression> getProgression(const Runnable<_Args...> &runnable) noexcept;
+namespace detail {
+inline std::atomic<std::size_t> numberOfSpilledRunnables{0};
+}
 
-    template<typename ..._Args>
-    friend std::vector<Issue> getIssues(const Runnable<_Args...> &runnable) noexcept;
+/**
+ * Function to retrieve how many runnables were too large to be stored inline
+ * and needed a dynamic allocation
+ * @return The number of spilled runnables since the beginning of the program
+ */
+inline std::size_t getNumberOfSpilledRunnables() noexcept {
+    return detail::numberOfSpilledRunnables.load(std::memory_order_relaxed);
+}
 
-public:
-    template<typename T>
-    Runnable(T t) noexcept :
-        m_objectToRun{std::make_unique<Model<special_decay_t<T>, Args...>>(t)} {}
+/**
+ * Runnable able to carry any task, timed as ClockPolitic tells
+ */
+template<typename ClockPolitic, typename ...Args>
+class BasicRunnable : public RunnableState<BasicRunnable<ClockPolitic, Args...>, ClockPolitic> {
+    static constexpr std::size_t inlineSize = MAN_RUNNABLE_INLINE_SIZE;
 
-    Runnable(Runnable &&runnable) noexcept = default;
+    template<typename ModelType>
+    static constexpr bool isInlinable = sizeof(ModelType) <= inlineSize &&
+                                        alignof(ModelType) <= alignof(std::max_align_t) &&
+                                        std::is_nothrow_move_constructible_v<ModelType>;
 
-    Runnable(const Runnable &) = delete;
-    Runnable() noexcept = delete;
+    template<typename _ClockPolitic, typename ..._Args>
+    friend std::optional<Progression> getProgression(const BasicRunnable<_ClockPolitic, _Args...> &runnable) noexcept;
 
+    template<typename _ClockPolitic, typename ..._Args>
+    friend std::vector<Issue> getIssues(const BasicRunnable<_ClockPolitic, _Args...> &runnable) noexcept;
 
+public:
     /**
-     * Function to retrieve the elapsed time of the runnable object since the task was launch
-     * @return The time
+     * The task is stored inside the runnable if it is small enough,
+     * otherwise it is allocated on the heap
      */
-    template<typename TimeUnit = std::chrono::milliseconds>
-    TimeUnit getElapsedTime() noexcept {
-        using namespace std::chrono;
+    template<typename T>
+    BasicRunnable(T t) noexcept {
+        using ModelType = Model<special_decay_t<T>, Args...>;
+
+        if constexpr(isInlinable<ModelType>) {
+            m_objectToRun = new (m_buffer) ModelType(std::move(t));
+        }
 
-        if(!isStarted()) {
-            return TimeUnit{0};
+        else {
+            detail::numberOfSpilledRunnables.fetch_add(1, std::memory_order_relaxed);
+            m_objectToRun = new ModelType(std::move(t));
         }
+    }
 
-        if(isFinished()) {
-            // Acquire the values m_start and m_end at the same time
-            std::atomic_thread_fence(std::memory_order_acquire);
-            return duration_cast<TimeUnit>(m_endTime - m_startTime);
+    BasicRunnable(BasicRunnable &&runnable) noexcept :
+        RunnableState<BasicRunnable, ClockPolitic>{std::move(runnable)} {
+        if(runnable.isInline()) {
+            m_objectToRun = runnable.m_objectToRun->moveTo(m_buffer);
+            runnable.destroyObjectToRun();
         }
 
         else {
-            // Acquire only the m_startTime
-            std::atomic_thread_fence(std::memory_order_acquire);
-            return duration_cast<TimeUnit>(Clock::now() - m_startTime);
+            m_objectToRun = std::exchange(runnable.m_objectToRun, nullptr);
         }
     }
 
-    /**
-     * Function to retrieve the remaining time of the runnable object if it is available
-     *
-     * If the progression is not available for many reason (not launched, no getProgression function),
-     * the optional will be empty
-     * @return The number of millisecond until the end of the task
-     */
-    template<typename TimeUnit = std::chrono::milliseconds>
-    std::optional<TimeUnit> getRemainingTime() noexcept {
-        using namespace std::chrono;
-        auto epsilon = 0.00001;
-
-        if(auto progression = getProgression(*this); progression.has_value()) {
-            auto currentTime = getElapsedTime<nanoseconds>();
-            auto timeInNanoseconds = (1.0 / (*progression + epsilon)) * currentTime;
-            return duration_cast<TimeUnit>((timeInNanoseconds) * (1.0 - *progression));
-        }
+    BasicRunnable(const BasicRunnable &) = delete;
+    BasicRunnable &operator=(const BasicRunnable &) = delete;
+    BasicRunnable() noexcept = delete;
 
-        return {};
+    ~BasicRunnable() noexcept {
+        destroyObjectToRun();
     }
 
     /**
      * This function executes the function carried by the runnable object
      */
     void launch(Args... args) noexcept {
-        assert(!isStarted() && "Runnable must not be run twice");
         assert(m_objectToRun != nullptr);
-        m_startTime = Clock::now();
-        std::atomic_thread_fence(std::memory_order_release);
-        m_isStarted.store(true, std::memory_order_relaxed);
-
-        m_objectToRun->launch(std::forward<Args>(args)...);
-
-        m_endTime = Clock::now();
-        std::atomic_thread_fence(std::memory_order_release);
-        m_isFinished.store(true, std::memory_order_relaxed);
-    }
-
-    void waitUntilFinished() const noexcept {
-        while(!isFinished()) {
-            std::this_thread::yield();
+        if(this->start()) {
+            m_objectToRun->launch(std::forward<Args>(args)...);
         }
+        this->finish();
     }
 
     /**
      * This function executes the function carried by the runnable object
      */
     void operator()(Args... args) noexcept {
-        launch(std::forward(args)...);
-    }
-
-    bool isFinished() const noexcept {
-        return m_isFinished.load(std::memory_order_relaxed);
+        launch(std::forward<Args>(args)...);
     }
 
     /**
-     * This function return the result of the function carried by the runnable
+     * This function moves the result of the function carried by the runnable out of it
      *
      * This function assert that 'T' is exactly what the function returns
-     * This function throws std::invalid_argument if the result is not available
+     * This function throws std::runtime_error if the result is not available, or if the runnable was cancelled
      * @return T - The result of the function
-     * @throw std::invalid_argument
+     * @throw std::runtime_error
      */
     template<typename T>
     T getResult() {
+        return std::move(getResultReference<T>());
+    }
+
+    /**
+     * This function return a reference on the result of the function carried by the runnable
+     *
+     * This function assert that 'T' is exactly what the function returns
+     * This function throws std::runtime_error if the result is not available, or if the runnable was cancelled
+     * @return T& - The result of the function, owned by the runnable
+     * @throw std::runtime_error
+     */
+    template<typename T>
+    T &getResultReference() {
         m_objectToRun->template checkReturnType<T>();
 
-        if(!isFinished()) {
+        if(!this->isFinished() || this->isCancelled()) {
             throw std::runtime_error{"The result is not available"};
         }
 
         std::atomic_thread_fence(std::memory_order_acquire);
+        return *static_cast<T*>(m_objectToRun->resultAddress());
+    }
 
-        T result;
-        m_objectToRun->retrieveResult(&result);
-        return result;
+private:
+    bool isInline() const noexcept {
+        auto object = reinterpret_cast<const unsigned char*>(m_objectToRun);
+        return std::less_equal<>{}(m_buffer, object) && std::less<>{}(object, m_buffer + inlineSize);
     }
 
-    bool isStarted() const noexcept {
-        return m_isStarted.load(std::memory_order_relaxed);
+    void destroyObjectToRun() noexcept {
+        if(isInline()) {
+            m_objectToRun->~Concept();
+        }
+
+        else {
+            delete m_objectToRun;
+        }
+
+        m_objectToRun = nullptr;
     }
 
 private:
-    std::unique_ptr<Concept<Args...>> m_objectToRun;
-    Clock::time_point m_startTime;
-    copyable_atomic<bool> m_isStarted{false};
-    Clock::time_point m_endTime;
-    copyable_atomic<bool> m_isFinished{false};
+    alignas(std::max_align_t) unsigned char m_buffer[inlineSize];
+    Concept<Args...> *m_objectToRun{nullptr};
 };
 
+template<typename ...Args>
+using Runnable = BasicRunnable<default_clock_politic, Args...>;
+
 /**
  * Function to retrieve the progression of the runnable object
  *
@@ -146,8 +168,8 @@ private:
  * @param runnable
  * @return The progression of the task
  */
-template<typename ...Args>
-inline std::optional<Progression> getProgression(const Runnable<Args...> &runnable) noexcept  {
+template<typename ClockPolitic, typename ...Args>
+inline std::optional<Progression> getProgression(const BasicRunnable<ClockPolitic, Args...> &runnable) noexcept  {
     if(!runnable.isStarted()) {
         return 0.0f;
     }
@@ -164,8 +186,8 @@ inline std::optional<Progression> getProgression(const Runnable<Args...> &runnab
  * @param runnable - The task from which we want to retrieve all the issues
  * @return All issues.
  */
-template<typename ...Args>
-inline std::vector<Issue> getIssues(const Runnable<Args...> &runnable) noexcept  {
+template<typename ClockPolitic, typename ...Args>
+inline std::vector<Issue> getIssues(const BasicRunnable<ClockPolitic, Args...> &runnable) noexcept  {
     return runnable.m_objectToRun->issues();
 }
 
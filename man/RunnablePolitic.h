@@ -0,0 +1,33 @@
+#pragma once
+#include "Runnable.h"
+#include "TypedRunnable.h"
+
+namespace man {
+struct runnable_politic_tag{};
+
+/**
+ * Politic that allows the thread pool to run any kind of task.
+ *
+ * The tasks are called through virtual functions
+ */
+struct polymorphic_runnable_politic {
+    using politic_category = runnable_politic_tag;
+
+    template<typename ClockPolitic, typename ...Args>
+    using runnable = BasicRunnable<ClockPolitic, Args...>;
+};
+
+/**
+ * Politic that allows the thread pool to run only tasks of type T.
+ *
+ * The tasks are stored contiguously without indirection, and are called
+ * without virtual functions
+ */
+template<typename T>
+struct monomorphic_runnable_politic {
+    using politic_category = runnable_politic_tag;
+
+    template<typename ClockPolitic, typename ...Args>
+    using runnable = BasicTypedRunnable<ClockPolitic, T, Args...>;
+};
+}
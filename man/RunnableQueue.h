@@ -4,6 +4,8 @@
 #include <condition_variable>
 #include <tuple>
 #include "Runnable.h"
+#include "Metrics.h"
+#include "CacheLine.h"
 
 namespace man {
 template<typename...>
@@ -12,15 +14,29 @@ struct type_list{};
 template<typename...>
 class RunnableQueue;
 
-template<typename... OnlyArgs, typename... ContextsAndArgs>
-class RunnableQueue<type_list<ContextsAndArgs...>, type_list<OnlyArgs...>> {
+/**
+ * Queue of pointers to _RunnableAndArgs, which is a tuple of a runnable and its arguments
+ */
+template<typename _RunnableAndArgs>
+class alignas(cacheLineSize) RunnableQueue<_RunnableAndArgs> {
 public:
-    using RunnableAndArgs = std::tuple<Runnable<ContextsAndArgs...>, OnlyArgs...>;
+    using RunnableAndArgs = _RunnableAndArgs;
 
     RunnableQueue() noexcept {}
 
     bool isDone() const noexcept {
-        return m_done;
+        return m_done.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * The result is only a hint when other threads are working on the queue
+     */
+    bool isEmpty() const noexcept {
+        return m_size.load(std::memory_order_relaxed) == 0;
+    }
+
+    std::size_t size() const noexcept {
+        return m_size.load(std::memory_order_relaxed);
     }
 
     template<typename ...try_to_lock>
@@ -28,12 +44,16 @@ public:
         std::unique_lock lock{m_mutex, tryToLock...};
 
         if(!lock) {
+            MAN_METRIC_ADD(m_failedLocks, 1);
             return nullptr;
         }
 
-        m_conditionVariable.wait(lock, [this] {
-            return m_done || !m_runnables.empty();
-        });
+        // Only the blocking pop waits, otherwise a worker could sleep on the queue of another one
+        if constexpr(sizeof...(try_to_lock) == 0) {
+            m_conditionVariable.wait(lock, [this] {
+                return m_done || !m_runnables.empty();
+            });
+        }
 
         if(m_done || m_runnables.empty()) {
             return nullptr;
@@ -41,6 +61,7 @@ public:
 
         auto runnable = m_runnables.back();
         m_runnables.pop_back();
+        m_size.store(m_runnables.size(), std::memory_order_relaxed);
         return runnable;
     }
 
@@ -51,9 +72,11 @@ public:
 
             if(lock) {
                 m_runnables.emplace_back(runnableToPush);
+                m_size.store(m_runnables.size(), std::memory_order_relaxed);
             }
 
             else {
+                MAN_METRIC_ADD(m_failedLocks, 1);
                 return false;
             }
         }
@@ -61,10 +84,22 @@ public:
         return true;
     }
 
+    /**
+     * Push all the runnables from first to last while taking the lock only once
+     */
+    void pushBulk(RunnableAndArgs *const *first, RunnableAndArgs *const *last) noexcept {
+        {
+            std::scoped_lock lock{m_mutex};
+            m_runnables.insert(m_runnables.end(), first, last);
+            m_size.store(m_runnables.size(), std::memory_order_relaxed);
+        }
+        m_conditionVariable.notify_all();
+    }
+
     void finish() noexcept {
         {
             std::scoped_lock lock{m_mutex};
-            m_done = true;
+            m_done.store(true, std::memory_order_relaxed);
         }
         m_conditionVariable.notify_all();
     }
@@ -79,6 +114,12 @@ private:
     std::vector<RunnableAndArgs*> m_runnables;
     std::mutex m_mutex;
     std::condition_variable m_conditionVariable;
-    bool m_done{false};
+    std::atomic<std::size_t> m_size{0};
+    std::atomic<bool> m_done{false};
+};
+
+template<typename... OnlyArgs, typename... ContextsAndArgs>
+class RunnableQueue<type_list<ContextsAndArgs...>, type_list<OnlyArgs...>> :
+        public RunnableQueue<std::tuple<Runnable<ContextsAndArgs...>, OnlyArgs...>> {
 };
 }
@@ -0,0 +1,318 @@
+#pragma once
+#include <thread>
+#include <optional>
+#include <utility>
+#include <cstdint>
+#include "ClockPolitic.h"
+#include "RangeType.h"
+#include "WaitPolitic.h"
+
+namespace man {
+/**
+ * A task launched once a runnable is finished
+ */
+struct alignas(16) Continuation {
+    virtual ~Continuation() noexcept = default;
+    virtual void launch() noexcept = 0;
+
+    /**
+     * Called instead of launch if the runnable was cancelled
+     */
+    virtual void cancel() noexcept {}
+
+    Continuation *m_next{nullptr};
+};
+
+namespace detail {
+/**
+ * When a runnable started and finished, nothing if its clock politic is no_clock_politic
+ */
+template<typename ClockPolitic, bool = ClockPolitic::isEnabled>
+struct RunnableTimes {
+    using TimePoint = typename ClockPolitic::clock::time_point;
+
+    TimePoint m_startTime;
+    TimePoint m_endTime;
+};
+
+template<typename ClockPolitic>
+struct RunnableTimes<ClockPolitic, false> {};
+}
+
+/**
+ * State shared by all kinds of runnable : is it started, is it finished, is it cancelled,
+ * and when it started and finished, as ClockPolitic tells.
+ *
+ * Derived must be found by getProgression through ADL
+ */
+template<typename Derived, typename ClockPolitic = default_clock_politic>
+class RunnableState : private detail::RunnableTimes<ClockPolitic> {
+    using Times = detail::RunnableTimes<ClockPolitic>;
+
+    // m_state is the head of the continuations, and its four low bits tell if the runnable
+    // is started, finished and cancelled, and if its continuations are done. Once it is finished,
+    // the continuations are launched at once. The waiters are woken up once the continuations are done,
+    // so they do not move the result out while a continuation reads it
+    static constexpr std::uintptr_t startedBit = 1;
+    static constexpr std::uintptr_t finishedBit = 2;
+    static constexpr std::uintptr_t cancelledBit = 4;
+    static constexpr std::uintptr_t settledBit = 8;
+    static constexpr std::uintptr_t stateBits = startedBit | finishedBit | cancelledBit | settledBit;
+    static_assert(alignof(Continuation) > stateBits, "The low bits of a continuation address must be free");
+
+public:
+    RunnableState() noexcept = default;
+
+    RunnableState(RunnableState &&state) noexcept :
+        Times{state},
+        m_state{state.m_state.exchange(0, std::memory_order_relaxed)} {}
+
+    RunnableState(const RunnableState &) = delete;
+    RunnableState &operator=(const RunnableState &) = delete;
+
+    /**
+     * The continuations belong to the runnable
+     */
+    ~RunnableState() noexcept {
+        deleteContinuations();
+    }
+
+    /**
+     * Make the runnable ready to be launched once again, its continuations are destroyed.
+     *
+     * It must not be called while the runnable is running or being waited for
+     */
+    void reset() noexcept {
+        assert((!isStarted() || isFinished()) && "A running runnable must not be reset");
+        deleteContinuations();
+    }
+
+    /**
+     * Function to retrieve the elapsed time of the runnable object since the task was launch
+     *
+     * It is not available with no_clock_politic
+     * @return The time
+     */
+    template<typename TimeUnit = std::chrono::milliseconds>
+    TimeUnit getElapsedTime() noexcept {
+        using namespace std::chrono;
+        static_assert(ClockPolitic::isEnabled, "The runnable is not timed, use another clock politic");
+
+        if constexpr(ClockPolitic::isEnabled) {
+            if(!isStarted()) {
+                return TimeUnit{0};
+            }
+
+            if(isFinished()) {
+                // Acquire the values m_start and m_end at the same time
+                std::atomic_thread_fence(std::memory_order_acquire);
+                return duration_cast<TimeUnit>(this->m_endTime - this->m_startTime);
+            }
+
+            else {
+                // Acquire only the m_startTime
+                std::atomic_thread_fence(std::memory_order_acquire);
+                return duration_cast<TimeUnit>(ClockPolitic::clock::now() - this->m_startTime);
+            }
+        }
+
+        else {
+            return TimeUnit{0};
+        }
+    }
+
+    /**
+     * Function to retrieve the remaining time of the runnable object if it is available
+     *
+     * If the progression is not available for many reason (not launched, no getProgression function),
+     * the optional will be empty. It is not available with no_clock_politic
+     * @return The number of millisecond until the end of the task
+     */
+    template<typename TimeUnit = std::chrono::milliseconds>
+    std::optional<TimeUnit> getRemainingTime() noexcept {
+        using namespace std::chrono;
+        auto epsilon = 0.00001;
+
+        if(auto progression = getProgression(static_cast<const Derived&>(*this)); progression.has_value()) {
+            auto currentTime = getElapsedTime<nanoseconds>();
+            auto timeInNanoseconds = (1.0 / (*progression + epsilon)) * currentTime;
+            return duration_cast<TimeUnit>((timeInNanoseconds) * (1.0 - *progression));
+        }
+
+        return {};
+    }
+
+    /**
+     * Wait until the task is finished and the continuations added before are done,
+     * the thread waits as WaitPolitic tells
+     */
+    template<typename WaitPolitic = default_wait_politic>
+    void waitUntilFinished() const noexcept {
+        // Adding a continuation changes the state without finishing the runnable
+        for(auto state = m_state.load(std::memory_order_acquire); !(state & settledBit);
+            state = m_state.load(std::memory_order_acquire)) {
+            WaitPolitic::waitWhileEqual(m_state, state);
+        }
+    }
+
+    bool isFinished() const noexcept {
+        return m_state.load(std::memory_order_relaxed) & finishedBit;
+    }
+
+    bool isStarted() const noexcept {
+        return m_state.load(std::memory_order_relaxed) & startedBit;
+    }
+
+    bool isCancelled() const noexcept {
+        return m_state.load(std::memory_order_relaxed) & cancelledBit;
+    }
+
+    /**
+     * Cancel the runnable if it is not started yet.
+     *
+     * A cancelled runnable stays in its queue, and it is finished without being run once
+     * a worker takes it. Its continuations are cancelled instead of being launched.
+     * @return true if the task will not be run
+     */
+    bool cancel() noexcept {
+        auto state = m_state.load(std::memory_order_relaxed);
+
+        do {
+            if(state & startedBit) {
+                return state & cancelledBit;
+            }
+        } while(!m_state.compare_exchange_weak(state, state | cancelledBit,
+                                               std::memory_order_acq_rel,
+                                               std::memory_order_relaxed));
+        return true;
+    }
+
+    /**
+     * Add a continuation without lock.
+     *
+     * If the runnable is not finished, the continuation is launched by the thread
+     * that finishes the runnable, just after it, after the continuations added before. Otherwise, it is launched at once
+     * by the calling thread.
+     * @param continuation - The runnable takes the ownership
+     */
+    void addContinuation(Continuation *continuation) noexcept {
+        auto state = m_state.load(std::memory_order_relaxed);
+        std::uintptr_t newState;
+
+        do {
+            continuation->m_next = reinterpret_cast<Continuation*>(state & ~stateBits);
+            newState = reinterpret_cast<std::uintptr_t>(continuation) | (state & stateBits);
+        } while(!m_state.compare_exchange_weak(state, newState,
+                                               std::memory_order_acq_rel,
+                                               std::memory_order_relaxed));
+
+        if(state & cancelledBit && state & finishedBit) {
+            continuation->cancel();
+        }
+
+        else if(state & finishedBit) {
+            continuation->launch();
+        }
+    }
+
+    /**
+     * Finish a cancelled runnable which is not started, without the arguments to launch it with.
+     *
+     * Its waiters are woken up and its continuations are cancelled, as if a worker took it
+     */
+    void finishCancelled() noexcept {
+        assert(isCancelled() && !isStarted() && "Only a cancelled runnable which is not started may be finished so");
+        start();
+        finish();
+    }
+
+protected:
+    /**
+     * Must be called just before the task is executed
+     * @return false if the runnable is cancelled, the task must not be executed
+     */
+    bool start() noexcept {
+        assert(!isStarted() && "Runnable must not be run twice");
+
+        if constexpr(ClockPolitic::isEnabled) {
+            this->m_startTime = ClockPolitic::clock::now();
+        }
+
+        // Publish the start time
+        return !(m_state.fetch_or(startedBit, std::memory_order_release) & cancelledBit);
+    }
+
+    /**
+     * Must be called just after the task is executed
+     */
+    void finish() noexcept {
+        if constexpr(ClockPolitic::isEnabled) {
+            this->m_endTime = ClockPolitic::clock::now();
+        }
+
+        // Publish the result of the task and its end time to the continuations, and take them
+        auto state = m_state.fetch_or(finishedBit, std::memory_order_acq_rel);
+
+        if(state & cancelledBit) {
+            cancelContinuations(state);
+        }
+
+        else {
+            launchContinuations(state);
+        }
+
+        // The waiters may now move the result out
+        m_state.fetch_or(settledBit, std::memory_order_release);
+        notifyWaiters(m_state);
+    }
+
+private:
+    void deleteContinuations() noexcept {
+        auto state = m_state.exchange(0, std::memory_order_acquire);
+        auto continuation = reinterpret_cast<Continuation*>(state & ~stateBits);
+
+        while(continuation != nullptr) {
+            delete std::exchange(continuation, continuation->m_next);
+        }
+    }
+
+    /**
+     * The continuations are pushed in front of the list, so it is reversed to launch them
+     * in the order they were added, then restored for deleteContinuations
+     */
+    void launchContinuations(std::uintptr_t state) noexcept {
+        auto first = reverse(reinterpret_cast<Continuation*>(state & ~stateBits));
+
+        for(auto continuation = first; continuation != nullptr; continuation = continuation->m_next) {
+            continuation->launch();
+        }
+
+        reverse(first);
+    }
+
+    void cancelContinuations(std::uintptr_t state) noexcept {
+        auto first = reverse(reinterpret_cast<Continuation*>(state & ~stateBits));
+
+        for(auto continuation = first; continuation != nullptr; continuation = continuation->m_next) {
+            continuation->cancel();
+        }
+
+        reverse(first);
+    }
+
+    static Continuation *reverse(Continuation *continuation) noexcept {
+        Continuation *reversed = nullptr;
+
+        while(continuation != nullptr) {
+            auto next = continuation->m_next;
+            continuation->m_next = reversed;
+            reversed = std::exchange(continuation, next);
+        }
+
+        return reversed;
+    }
+
+private:
+    std::atomic<std::uintptr_t> m_state{0};
+};
+}
@@ -0,0 +1,240 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <limits>
+#include <cstdint>
+#include <cassert>
+#include "CacheLine.h"
+
+namespace man {
+/**
+ * Storage of runnables with stable addresses.
+ *
+ * The memory is split into segments of SegmentSize slots. A segment is never
+ * moved nor freed before the destruction of the storage, so a pointer to a
+ * runnable stays valid while the runnable lives.
+ * The slots of the released runnables are recycled through a lock-free free list.
+ *
+ * Runnables are either :
+ *  - attached : they live until clear() is called
+ *  - detached : they are released as soon as releaseIfDetached() is called
+ *
+ * All the functions except clear() can be called from any thread
+ */
+template<typename T, std::size_t SegmentSize = 1024, std::size_t MaxSegments = 4096>
+class RunnableStorage {
+    static constexpr std::uint32_t nil = std::numeric_limits<std::uint32_t>::max();
+
+    static_assert((SegmentSize & (SegmentSize - 1)) == 0, "SegmentSize must be a power of two");
+    static_assert(SegmentSize * MaxSegments < nil, "Too many slots");
+
+    /**
+     * Each slot has its own cache lines : the worker finishing a runnable never
+     * writes the line of the runnable that a submitter is creating next to it
+     */
+    struct alignas(cacheLineSize) Slot {
+        alignas(T) unsigned char m_storage[sizeof(T)];
+        std::atomic<std::uint32_t> m_next{nil};
+        std::uint32_t m_nextAttached{nil};
+        std::uint32_t m_index{nil};
+        bool m_isDetached{false};
+
+        T *get() noexcept {
+            return std::launder(reinterpret_cast<T*>(m_storage));
+        }
+    };
+
+    /**
+     * The head of the free list is tagged to avoid the ABA problem
+     */
+    static constexpr std::uint64_t makeHead(std::uint32_t index, std::uint32_t tag) noexcept {
+        return (static_cast<std::uint64_t>(tag) << 32) | index;
+    }
+
+    static constexpr std::uint32_t indexOf(std::uint64_t head) noexcept {
+        return static_cast<std::uint32_t>(head);
+    }
+
+    static constexpr std::uint32_t tagOf(std::uint64_t head) noexcept {
+        return static_cast<std::uint32_t>(head >> 32);
+    }
+
+public:
+    RunnableStorage() noexcept {
+        for(auto &segment : m_segments) {
+            segment.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    RunnableStorage(const RunnableStorage&) = delete;
+    RunnableStorage &operator=(const RunnableStorage&) = delete;
+
+    /**
+     * Construct a runnable that lives until clear() is called
+     * @throw std::bad_alloc if the storage is full
+     */
+    template<typename ...Ts>
+    T *emplace(Ts&& ...args) {
+        auto &slot = construct(false, std::forward<Ts>(args)...);
+        slot.m_nextAttached = m_attachedHead.load(std::memory_order_relaxed);
+
+        while(!m_attachedHead.compare_exchange_weak(slot.m_nextAttached, slot.m_index,
+                                                    std::memory_order_release,
+                                                    std::memory_order_relaxed));
+        return slot.get();
+    }
+
+    /**
+     * Construct a runnable that is released by releaseIfDetached
+     * @throw std::bad_alloc if the storage is full
+     */
+    template<typename ...Ts>
+    T *emplaceDetached(Ts&& ...args) {
+        return construct(true, std::forward<Ts>(args)...).get();
+    }
+
+    /**
+     * Allocate at once the segments needed to create count new slots,
+     * so the next count emplacements do not allocate.
+     *
+     * The released slots are recycled first : nothing is allocated while some are free,
+     * the emplacements allocate the missing segments themselves
+     */
+    void reserve(std::size_t count) {
+        if(indexOf(m_freeHead.load(std::memory_order_relaxed)) != nil) {
+            return;
+        }
+
+        auto size = m_size.load(std::memory_order_relaxed);
+        auto lastSegment = std::min((size + count + SegmentSize - 1) / SegmentSize, MaxSegments);
+
+        std::scoped_lock lock{m_segmentMutex};
+        for(auto segment = size / SegmentSize; segment < lastSegment; ++segment) {
+            if(m_segments[segment].load(std::memory_order_relaxed) == nullptr) {
+                m_segments[segment].store(new Slot[SegmentSize], std::memory_order_release);
+            }
+        }
+    }
+
+    /**
+     * Destroy the runnable and recycle its slot if it is detached
+     * @param value - Must come from this storage
+     */
+    void releaseIfDetached(T *value) noexcept {
+        auto &slot = *reinterpret_cast<Slot*>(value);
+
+        if(slot.m_isDetached) {
+            release(slot);
+        }
+    }
+
+    /**
+     * Destroy all the attached runnables.
+     *
+     * It must not be called while other threads are using attached runnables
+     */
+    void clear() noexcept {
+        auto index = m_attachedHead.exchange(nil, std::memory_order_acquire);
+
+        while(index != nil) {
+            auto &slot = slotAt(index);
+            index = slot.m_nextAttached;
+            release(slot);
+        }
+    }
+
+    /**
+     * @return the number of slots ever created, which is the peak number of
+     * runnables alive at the same time
+     */
+    std::size_t capacity() const noexcept {
+        return std::min<std::size_t>(m_size.load(std::memory_order_relaxed), SegmentSize * MaxSegments);
+    }
+
+    ~RunnableStorage() noexcept {
+        clear();
+
+        for(auto &segment : m_segments) {
+            delete[] segment.load(std::memory_order_relaxed);
+        }
+    }
+
+private:
+    template<typename ...Ts>
+    Slot &construct(bool isDetached, Ts&& ...args) {
+        auto &slot = acquire();
+        new (slot.m_storage) T(std::forward<Ts>(args)...);
+        slot.m_isDetached = isDetached;
+        return slot;
+    }
+
+    void release(Slot &slot) noexcept {
+        slot.get()->~T();
+
+        auto head = m_freeHead.load(std::memory_order_relaxed);
+        do {
+            slot.m_next.store(indexOf(head), std::memory_order_relaxed);
+        } while(!m_freeHead.compare_exchange_weak(head, makeHead(slot.m_index, tagOf(head) + 1),
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed));
+    }
+
+    Slot &acquire() {
+        auto head = m_freeHead.load(std::memory_order_acquire);
+
+        while(indexOf(head) != nil) {
+            auto &slot = slotAt(indexOf(head));
+            auto next = slot.m_next.load(std::memory_order_relaxed);
+
+            if(m_freeHead.compare_exchange_weak(head, makeHead(next, tagOf(head) + 1),
+                                                std::memory_order_acquire,
+                                                std::memory_order_acquire)) {
+                return slot;
+            }
+        }
+
+        return createSlot();
+    }
+
+    Slot &createSlot() {
+        auto index = m_size.fetch_add(1, std::memory_order_relaxed);
+
+        if(index >= SegmentSize * MaxSegments) {
+            throw std::bad_alloc{};
+        }
+
+        auto &segment = m_segments[index / SegmentSize];
+        auto slots = segment.load(std::memory_order_acquire);
+
+        if(slots == nullptr) {
+            std::scoped_lock lock{m_segmentMutex};
+            slots = segment.load(std::memory_order_relaxed);
+
+            if(slots == nullptr) {
+                slots = new Slot[SegmentSize];
+                segment.store(slots, std::memory_order_release);
+            }
+        }
+
+        auto &slot = slots[index % SegmentSize];
+        slot.m_index = static_cast<std::uint32_t>(index);
+        return slot;
+    }
+
+    Slot &slotAt(std::uint32_t index) noexcept {
+        auto slots = m_segments[index / SegmentSize].load(std::memory_order_acquire);
+        assert(slots != nullptr);
+        return slots[index % SegmentSize];
+    }
+
+private:
+    std::array<std::atomic<Slot*>, MaxSegments> m_segments;
+    std::atomic<std::uint64_t> m_freeHead{makeHead(nil, 0)};
+    std::atomic<std::uint32_t> m_attachedHead{nil};
+    std::atomic<std::size_t> m_size{0};
+    std::mutex m_segmentMutex;
+};
+}
@@ -0,0 +1,260 @@
+#pragma once
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <cassert>
+#include <utility>
+#include <iterator>
+#include "Runnable.h"
+#include "WaitPolitic.h"
+
+namespace man {
+/**
+ * Directed acyclic graph of runnables, run by a thread pool with the contexts Contexts...
+ *
+ * The nodes and the edges are declared once. Each node counts its unfinished predecessors,
+ * and it is pushed to the pool as soon as the last one is finished : there is no barrier
+ * between the waves of the graph.
+ * The graph may be run again once it is finished, without being rebuilt.
+ * If the pool drops the runnable of a node, by shutdown(DROP_PENDING) for instance, the nodes
+ * which are not started yet are cancelled, so wait() still returns.
+ */
+template<typename ...Contexts>
+class TaskGraph {
+public:
+    using NodeId = std::size_t;
+    using RunnableType = Runnable<Contexts&...>;
+
+private:
+    struct Node {
+        template<typename T>
+        Node(NodeId id, T &&task) noexcept : m_id{id}, m_runnable{std::forward<T>(task)} {}
+
+        NodeId m_id;
+        RunnableType m_runnable;
+        std::vector<Node*> m_successors;
+        std::size_t m_numberOfPredecessors{0};
+        std::atomic<std::size_t> m_numberOfUnfinishedPredecessors{0};
+    };
+
+    /**
+     * The runnable pushed to the pool for each ready node.
+     *
+     * If it is destroyed without being run, the nodes it should have reached are cancelled
+     */
+    class NodeTask {
+    public:
+        NodeTask(TaskGraph *graph, Node *node) noexcept : m_graph{graph}, m_node{node} {}
+
+        NodeTask(NodeTask &&other) noexcept :
+            m_graph{std::exchange(other.m_graph, nullptr)}, m_node{other.m_node} {}
+
+        NodeTask(const NodeTask &) = delete;
+        NodeTask &operator=(const NodeTask &) = delete;
+
+        ~NodeTask() noexcept {
+            if(m_graph != nullptr) {
+                m_graph->cancelFrom(m_node);
+            }
+        }
+
+        void operator()(Contexts &...contexts) noexcept {
+            std::exchange(m_graph, nullptr)->runFrom(m_node, contexts...);
+        }
+
+    private:
+        TaskGraph *m_graph;
+        Node *m_node;
+    };
+
+public:
+    TaskGraph() noexcept = default;
+    TaskGraph(const TaskGraph &) = delete;
+    TaskGraph &operator=(const TaskGraph &) = delete;
+
+    ~TaskGraph() noexcept {
+        assert(!isRunning() && "The graph must be finished before it is destroyed");
+    }
+
+    /**
+     * Add a node which runs task
+     * @return The identifier of the node
+     */
+    template<typename T>
+    NodeId addNode(T &&task) {
+        assert(!isRunning());
+        m_nodes.emplace_back(m_nodes.size(), std::forward<T>(task));
+        return m_nodes.size() - 1;
+    }
+
+    /**
+     * Declare that after must not start before before is finished
+     */
+    void addEdge(NodeId before, NodeId after) {
+        assert(!isRunning());
+        assert(before < m_nodes.size() && after < m_nodes.size() && before != after);
+        m_nodes[before].m_successors.push_back(&m_nodes[after]);
+        m_nodes[after].m_numberOfPredecessors++;
+    }
+
+    /**
+     * Run all the nodes on pool without waiting for them.
+     *
+     * The graph must not be running. The pool must have the contexts of the graph and no Args
+     */
+    template<typename Pool>
+    void run(Pool &pool) {
+        assert(!isRunning() && "The graph is already running");
+        assert(isAcyclic() && "The graph must not have any cycle");
+
+        if(m_nodes.empty()) {
+            return;
+        }
+
+        std::vector<Node*> roots;
+        for(auto &node : m_nodes) {
+            node.m_runnable.reset();
+            node.m_numberOfUnfinishedPredecessors.store(node.m_numberOfPredecessors, std::memory_order_relaxed);
+
+            if(node.m_numberOfPredecessors == 0) {
+                roots.push_back(&node);
+            }
+        }
+
+        m_pushRunnable = [](void *pool, NodeTask task) {
+            static_cast<Pool*>(pool)->addRunnableAndForget(std::move(task));
+        };
+        m_pool = std::addressof(pool);
+        m_isCancelled.store(false, std::memory_order_relaxed);
+        m_unfinishedNodes.add(m_nodes.size());
+
+        // The tasks are created only once the graph is ready, a dropped one cancels the others
+        std::vector<NodeTask> tasks;
+        tasks.reserve(roots.size());
+        for(auto root : roots) {
+            tasks.emplace_back(this, root);
+        }
+
+        pool.addRunnablesAndForget(std::make_move_iterator(tasks.begin()), std::make_move_iterator(tasks.end()));
+    }
+
+    /**
+     * Wait until all the nodes are finished
+     */
+    template<typename WaitPolitic = default_wait_politic>
+    void wait() const noexcept {
+        m_unfinishedNodes.template wait<WaitPolitic>();
+    }
+
+    bool isRunning() const noexcept {
+        return !m_unfinishedNodes.isFinished();
+    }
+
+    /**
+     * true if a node of the last run was cancelled
+     */
+    bool isCancelled() const noexcept {
+        return m_isCancelled.load(std::memory_order_acquire);
+    }
+
+    /**
+     * The runnable of a node, to retrieve its result once the graph is finished
+     */
+    RunnableType &operator[](NodeId node) noexcept {
+        return m_nodes[node].m_runnable;
+    }
+
+    std::size_t size() const noexcept {
+        return m_nodes.size();
+    }
+
+private:
+    /**
+     * Run node, then keep running one of its ready successors on the same worker
+     * and push the other ones to the pool
+     */
+    void runFrom(Node *node, Contexts &...contexts) noexcept {
+        while(node != nullptr) {
+            if(m_isCancelled.load(std::memory_order_acquire)) {
+                node->m_runnable.cancel();
+            }
+
+            node->m_runnable.launch(contexts...);
+            node = finishNode(node);
+        }
+    }
+
+    /**
+     * Cancel node and the successors it makes ready, the other nodes are cancelled by runFrom.
+     *
+     * There are no contexts to launch them with, so they are finished cancelled without being launched
+     */
+    void cancelFrom(Node *node) noexcept {
+        m_isCancelled.store(true, std::memory_order_release);
+
+        while(node != nullptr) {
+            node->m_runnable.cancel();
+            node->m_runnable.finishCancelled();
+            node = finishNode(node);
+        }
+    }
+
+    /**
+     * Release the successors of node, push the ready ones to the pool but the first one,
+     * and count node finished
+     * @return The first ready successor, which the calling thread handles itself
+     */
+    Node *finishNode(Node *node) noexcept {
+        Node *next = nullptr;
+
+        for(auto successor : node->m_successors) {
+            if(successor->m_numberOfUnfinishedPredecessors.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                if(next == nullptr) {
+                    next = successor;
+                }
+
+                else {
+                    m_pushRunnable(m_pool, NodeTask{this, successor});
+                }
+            }
+        }
+
+        // The graph may be destroyed as soon as its last node is counted, but next is not null then
+        m_unfinishedNodes.finish();
+        return next;
+    }
+
+    bool isAcyclic() const {
+        std::vector<std::size_t> numberOfPredecessors;
+        std::vector<const Node*> ready;
+        for(auto &node : m_nodes) {
+            numberOfPredecessors.push_back(node.m_numberOfPredecessors);
+            if(node.m_numberOfPredecessors == 0) {
+                ready.push_back(&node);
+            }
+        }
+
+        std::size_t numberOfVisitedNodes{0};
+        while(!ready.empty()) {
+            auto node = ready.back();
+            ready.pop_back();
+            numberOfVisitedNodes++;
+
+            for(auto successor : node->m_successors) {
+                if(--numberOfPredecessors[successor->m_id] == 0) {
+                    ready.push_back(successor);
+                }
+            }
+        }
+
+        return numberOfVisitedNodes == m_nodes.size();
+    }
+
+private:
+    std::deque<Node> m_nodes;
+    CompletionCounter m_unfinishedNodes;
+    std::atomic<bool> m_isCancelled{false};
+    void *m_pool{nullptr};
+    void (*m_pushRunnable)(void *, NodeTask){nullptr};
+};
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include <atomic>
+#include <thread>
+#include <cassert>
+#include <utility>
+#include <type_traits>
+#include "WaitPolitic.h"
+
+namespace man {
+/**
+ * A set of tasks submitted to a pool, waited for together.
+ *
+ * The group counts its unfinished tasks, so waiting costs nothing more with the number
+ * of tasks the pool ran before. A group may be nested into another one : the tasks of the
+ * nested group are also tasks of its parent.
+ */
+template<typename Pool>
+class TaskGroup {
+    /**
+     * The task given to the pool : the group counts it finished once it is destroyed,
+     * so a task cancelled by the pool does not keep the group waiting
+     */
+    template<typename T>
+    class GroupTask {
+    public:
+        GroupTask(T task, TaskGroup *group) noexcept : m_task{std::move(task)}, m_group{group} {}
+
+        GroupTask(GroupTask &&other) noexcept :
+            m_task{std::move(other.m_task)}, m_group{std::exchange(other.m_group, nullptr)} {}
+
+        GroupTask(const GroupTask &) = delete;
+        GroupTask &operator=(const GroupTask &) = delete;
+
+        ~GroupTask() noexcept {
+            if(m_group != nullptr) {
+                m_group->finishTask();
+            }
+        }
+
+        template<typename ...Ts>
+        void operator()(Ts &&...values) noexcept {
+            if(!m_group->isCancelled()) {
+                m_task(std::forward<Ts>(values)...);
+            }
+        }
+
+    private:
+        T m_task;
+        TaskGroup *m_group;
+    };
+
+public:
+    explicit TaskGroup(Pool &pool) noexcept : m_pool{pool} {}
+
+    /**
+     * A group nested into parent, which must live longer
+     */
+    explicit TaskGroup(TaskGroup &parent) noexcept : m_pool{parent.m_pool}, m_parent{&parent} {}
+
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+    ~TaskGroup() noexcept {
+        assert(m_numberOfTasks.isFinished() && "The group must be finished before it is destroyed");
+    }
+
+    /**
+     * Submit task to the pool as a task of this group.
+     *
+     * The task is given the contexts and the arguments of the pool
+     */
+    template<typename T, typename ...Ts>
+    void add(T &&task, Ts &&...args) {
+        for(auto group = this; group != nullptr; group = group->m_parent) {
+            group->m_numberOfTasks.add();
+        }
+
+        m_pool.addRunnableAndForget(GroupTask<std::decay_t<T>>{std::forward<T>(task), this}, std::forward<Ts>(args)...);
+    }
+
+    /**
+     * Wait until all the tasks of the group are finished.
+     *
+     * A worker of the pool runs the pending runnables meanwhile, so a task may wait for
+     * its nested group without holding its worker. Another thread waits as WaitPolitic tells
+     */
+    template<typename WaitPolitic = default_wait_politic>
+    void wait() noexcept {
+        if(!m_pool.isCurrentThreadAWorker()) {
+            m_numberOfTasks.template wait<WaitPolitic>();
+            return;
+        }
+
+        while(!m_numberOfTasks.isFinished()) {
+            if(!m_pool.runPendingRunnable()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    /**
+     * The tasks of the group and of its nested groups which are not started yet are not run
+     */
+    void cancel() noexcept {
+        m_isCancelled.store(true, std::memory_order_relaxed);
+    }
+
+    bool isCancelled() const noexcept {
+        for(auto group = this; group != nullptr; group = group->m_parent) {
+            if(group->m_isCancelled.load(std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool isFinished() const noexcept {
+        return m_numberOfTasks.isFinished();
+    }
+
+private:
+    void finishTask() noexcept {
+        for(auto group = this; group != nullptr;) {
+            // The group may be destroyed as soon as its last task is counted
+            auto parent = group->m_parent;
+            group->m_numberOfTasks.finish();
+            group = parent;
+        }
+    }
+
+private:
+    Pool &m_pool;
+    TaskGroup *m_parent{nullptr};
+    CompletionCounter m_numberOfTasks;
+    std::atomic<bool> m_isCancelled{false};
+};
+}
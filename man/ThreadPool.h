@@ -2,17 +2,178 @@
 #include <thread>
 #include <algorithm>
 #include <tuple>
-#include "RunnableQueue.h"
+#include <vector>
+#include <iterator>
+#include <functional>
+#include <mutex>
+#include <memory>
+#include "Topology.h"
+#include "QueuePolitic.h"
+#include "RunnableStorage.h"
+#include "RunnablePolitic.h"
+#include "WaitPolitic.h"
+#include "Future.h"
+#include "Cancellation.h"
+#include "IssueChannel.h"
+#include "TimerWheel.h"
+#include "Coroutine.h"
+#include "Metrics.h"
 
 namespace man {
+/**
+ * What shutdown does with the runnables which are not started yet
+ */
+enum class ShutdownMode {
+    WAIT_PENDING,
+    DROP_PENDING
+};
+
+/**
+ * How many workers a thread pool has, and where they run
+ */
+struct ThreadPoolOptions {
+    explicit ThreadPoolOptions(std::size_t numberOfThreads) noexcept :
+        m_numberOfThreads{numberOfThreads}, m_maximumNumberOfThreads{numberOfThreads} {}
+
+    /**
+     * The pool starts with minimum workers, and spawns other ones up to maximum while there are
+     * more than m_spawnThreshold pending runnables by worker. A spawned worker retires once it has
+     * been idle for idleTimeout, and its contexts are destroyed with it.
+     */
+    static ThreadPoolOptions elastic(std::size_t minimum, std::size_t maximum,
+                                     std::chrono::milliseconds idleTimeout = std::chrono::milliseconds{100}) noexcept {
+        ThreadPoolOptions options{std::max<std::size_t>(minimum, 1)};
+        options.m_maximumNumberOfThreads = std::max(options.m_numberOfThreads, maximum);
+        options.m_idleTimeout = idleTimeout;
+        return options;
+    }
+
+    /**
+     * Each worker is pinned to one cpu, and neighbour workers run on neighbour cpus.
+     * If there are more workers than cpus, several workers share a cpu.
+     */
+    static ThreadPoolOptions pinnedToCpus(std::size_t numberOfThreads, const Topology &topology = Topology::current()) {
+        ThreadPoolOptions options{numberOfThreads};
+        auto &cpus = topology.cpus();
+
+        for(std::size_t i{0}; i < std::min(numberOfThreads, cpus.size()); ++i) {
+            options.m_cpuSets.push_back(CpuSet{cpus[i].m_cpu});
+        }
+
+        options.m_topology = std::make_shared<const Topology>(topology);
+        return options;
+    }
+
+    /**
+     * The workers are spread in contiguous blocks over the NUMA nodes,
+     * and each one may run on any cpu of its node
+     */
+    static ThreadPoolOptions pinnedToNodes(std::size_t numberOfThreads, const Topology &topology = Topology::current()) {
+        ThreadPoolOptions options{numberOfThreads};
+        std::vector<CpuSet> nodes;
+        unsigned currentNode{0};
+
+        // Without any cpu, the workers are not pinned
+        if(topology.cpus().empty()) {
+            return options;
+        }
+
+        // The cpus are sorted by node
+        for(auto &cpu : topology.cpus()) {
+            if(nodes.empty() || cpu.m_node != currentNode) {
+                nodes.emplace_back();
+                currentNode = cpu.m_node;
+            }
+            nodes.back().push_back(cpu.m_cpu);
+        }
+
+        for(std::size_t i{0}; i < numberOfThreads; ++i) {
+            options.m_cpuSets.push_back(nodes[i * nodes.size() / numberOfThreads]);
+        }
+
+        options.m_topology = std::make_shared<const Topology>(topology);
+        return options;
+    }
+
+    /**
+     * The cpus of the worker index, empty if it is not pinned
+     */
+    CpuSet cpuSetOf(std::size_t index) const {
+        return m_cpuSets.empty() ? CpuSet{} : m_cpuSets[index % m_cpuSets.size()];
+    }
+
+    /**
+     * The distances between the pinned workers within the topology they were pinned from,
+     * empty if they are not pinned
+     */
+    DistanceMatrix distancesBetweenWorkers() const {
+        if(m_cpuSets.empty()) {
+            return {};
+        }
+
+        std::vector<CpuSet> cpuSets;
+        for(std::size_t i{0}; i < std::max(m_numberOfThreads, m_maximumNumberOfThreads); ++i) {
+            cpuSets.push_back(cpuSetOf(i));
+        }
+
+        return (m_topology != nullptr ? *m_topology : Topology::current()).distances(cpuSets);
+    }
+
+    // The number of workers when the pool starts, which never retire
+    std::size_t m_numberOfThreads;
+    std::size_t m_maximumNumberOfThreads;
+    std::size_t m_spawnThreshold{4};
+    std::chrono::milliseconds m_idleTimeout{100};
+
+    // The worker i is pinned to m_cpuSets[i % m_cpuSets.size()], no worker is pinned if it is empty
+    std::vector<CpuSet> m_cpuSets;
+    // The topology m_cpuSets come from, the current one if it is null
+    std::shared_ptr<const Topology> m_topology;
+};
+
 template<typename ...>
 class ThreadPoolWithContextsAndArgs;
 
-template<typename ... Contexts, typename ... Args>
-class ThreadPoolWithContextsAndArgs<type_list<Contexts...>, type_list<Args...>> {
-    using Queue = RunnableQueue<type_list<Contexts..., Args...>, type_list<Args...>>;
-    using RunnableAndArgs = typename Queue::RunnableAndArgs;
+/**
+ * Politics... may contain :
+ *  - A queue politic : mutex_queue_politic (default), work_stealing_queue_politic or priority_queue_politic<>
+ *  - A runnable politic : polymorphic_runnable_politic (default) or monomorphic_runnable_politic<T>
+ *  - A wait politic : adaptive_wait_politic<Spins, Yields> (default), park_wait_politic or yield_wait_politic
+ *  - A clock politic : steady_clock_politic (default), tsc_clock_politic or no_clock_politic
+ */
+template<typename ... Contexts, typename ... Args, typename ... Politics>
+class ThreadPoolWithContextsAndArgs<type_list<Contexts...>, type_list<Args...>, Politics...> {
+    using QueuePolitic = select_politic_t<queue_politic_tag, mutex_queue_politic, Politics...>;
+    using RunnablePolitic = select_politic_t<runnable_politic_tag, polymorphic_runnable_politic, Politics...>;
+    using ClockPolitic = select_politic_t<clock_politic_tag, default_clock_politic, Politics...>;
+    // The contexts are given by reference, so a task may use the one of its worker as an accumulator
+    using RunnableType = typename RunnablePolitic::template runnable<ClockPolitic, Contexts&..., Args...>;
+    using RunnableAndArgs = std::tuple<RunnableType, Args...>;
+    using Scheduler = typename QueuePolitic::template scheduler<RunnableAndArgs>;
+    using WaitPolitic = select_politic_t<wait_politic_tag, default_wait_politic, Politics...>;
     using Context = std::tuple<Contexts...>;
+
+    /**
+     * A runnable with its arguments, which may be linked into the injection queue
+     */
+    struct Record : RunnableAndArgs, QueueNode {
+        template<typename ...Ts>
+        Record(Ts &&...values) : RunnableAndArgs{std::forward<Ts>(values)...} {}
+
+        // The runnable is cancelled when a worker takes it, if the token is cancelled
+        CancellationToken m_token;
+    };
+
+    struct WorkerIdentity {
+        const void *m_pool;
+        std::size_t m_index;
+        Context *m_context;
+    };
+
+    static constexpr std::size_t injectionBatchSize = 32;
+    static constexpr std::size_t spawnedWorkerSpinRounds = 64;
+    // A worker looks for a scheduled coroutine first once every this number of rounds
+    static constexpr std::size_t resumablePeriod = 16;
 public:
     /**
      * Construct the thread pool
@@ -21,14 +182,46 @@ public:
      */
     template<typename ...Fs>
     ThreadPoolWithContextsAndArgs(std::size_t numberOfThreads, Fs&& ...initializers) noexcept :
-        m_threadNumber{numberOfThreads},
-        m_queues{numberOfThreads} {
+        ThreadPoolWithContextsAndArgs{ThreadPoolOptions{numberOfThreads}, std::forward<Fs>(initializers)...} {}
+
+    /**
+     * Construct the thread pool with its workers placed as options tells.
+     *
+     * A pinned worker initializes its contexts once it is pinned, so their memory
+     * is allocated on its NUMA node. Thieves prefer the nearest workers.
+     * @param options
+     * @param function that initialize each Context variable
+     */
+    template<typename ...Fs>
+    ThreadPoolWithContextsAndArgs(const ThreadPoolOptions &options, Fs&& ...initializers) noexcept :
+        m_threads(maximumNumberOfThreads(options)),
+        m_scheduler{maximumNumberOfThreads(options), options.distancesBetweenWorkers()},
+        m_issues{maximumNumberOfThreads(options)},
+        m_numberOfActiveThreads{options.m_numberOfThreads},
+        m_minimumNumberOfThreads{options.m_numberOfThreads},
+        m_spawnThreshold{options.m_spawnThreshold},
+        m_idleTimeout{options.m_idleTimeout} {
         static_assert(sizeof...(Contexts) == sizeof...(Fs), "Each Context must have an initializer");
-        for(std::size_t i{0}; i < numberOfThreads; ++i) {
-            m_threads.emplace_back([this, i, &initializers...] {
-                run(std::ref(m_queues[i]),
-                    std::forward<Fs>(initializers)...);
-            });
+
+        // A clock calibrated when it is first read, like TscClock, is calibrated before any task is launched
+        if constexpr(ClockPolitic::isEnabled) {
+            ClockPolitic::clock::now();
+        }
+#if MAN_ENABLE_METRICS
+        m_metrics = std::vector<WorkerMetrics>(m_threads.size());
+#endif
+        // Each thread owns a copy of the initializers, which may be temporaries
+        m_startWorker = [this, options, initializers...](std::size_t index) {
+            return std::thread{[this, index, cpuSet = options.cpuSetOf(index), initializers...]() mutable {
+                if(!cpuSet.empty()) {
+                    pinCurrentThread(cpuSet);
+                }
+                run(index, initializers...);
+            }};
+        };
+
+        for(std::size_t i{0}; i < options.m_numberOfThreads; ++i) {
+            m_threads[i] = m_startWorker(i);
         }
     }
 
@@ -38,40 +231,310 @@ public:
     ThreadPoolWithContextsAndArgs() noexcept :
         ThreadPoolWithContextsAndArgs{std::max<std::size_t>(std::thread::hardware_concurrency() - 1, 1)}{}
 
+    /**
+     * The type returned by a task of type T
+     */
+    template<typename T>
+    using ResultOf = decltype(std::declval<special_decay_t<T>&>()(std::declval<Contexts&>()..., std::declval<Args>()...));
+
     /**
      * This function add a runnable into the runnables collection.
      *
-     * It schedules it to be launch by another thread later
+     * It schedules it to be launch by another thread later.
+     * The runnable lives until clear() is called
+     * @param runnable
+     * @return a handle on this runnable
+     */
+    template<typename T>
+    TaskHandle<ResultOf<T>, RunnableType> addRunnable(T &&runnable, Args... args) {
+        RunnableAndArgs *runnablePtr = m_runnables.emplace(
+            std::move(runnable),
+            std::forward<Args>(args)...
+        );
+
+        schedule(runnablePtr);
+
+        return TaskHandle<ResultOf<T>, RunnableType>{std::addressof(std::get<0>(*runnablePtr))};
+    }
+
+    /**
+     * Same as addRunnable, the scheduler uses hint to decide when to run it.
+     *
+     * The queue politic must support hints, like priority_queue_politic
+     * @param hint - A Priority or a deadline
+     */
+    template<typename T>
+    TaskHandle<ResultOf<T>, RunnableType> addRunnable(SchedulingHint hint, T &&runnable, Args... args) {
+        RunnableAndArgs *runnablePtr = m_runnables.emplace(
+            std::move(runnable),
+            std::forward<Args>(args)...
+        );
+
+        schedule(runnablePtr, hint);
+
+        return TaskHandle<ResultOf<T>, RunnableType>{std::addressof(std::get<0>(*runnablePtr))};
+    }
+
+    /**
+     * Same as addRunnable, the runnable is not run if token is cancelled before it starts.
+     *
+     * The task may also poll its own copy of the token
+     */
+    template<typename T>
+    TaskHandle<ResultOf<T>, RunnableType> addRunnable(CancellationToken token, T &&runnable, Args... args) {
+        Record *record = m_runnables.emplace(
+            std::move(runnable),
+            std::forward<Args>(args)...
+        );
+        record->m_token = std::move(token);
+
+        schedule(record);
+
+        return TaskHandle<ResultOf<T>, RunnableType>{std::addressof(std::get<0>(*record))};
+    }
+
+    /**
+     * This function schedules a runnable without giving it back.
+     *
+     * The memory of the runnable is recycled as soon as it is finished
      * @param runnable
-     * @return a ptr on this runnable
      */
     template<typename T>
-    Runnable<Contexts..., Args...> *addRunnable(T &&runnable, Args... args) {
-        RunnableAndArgs *runnablePtr = &m_runnables.emplace_back(
+    void addRunnableAndForget(T &&runnable, Args... args) {
+        RunnableAndArgs *runnablePtr = m_runnables.emplaceDetached(
             std::move(runnable),
             std::forward<Args>(args)...
         );
 
-        if(tryToPushToOneQueue(runnablePtr)) {
-            return std::addressof(std::get<0>(*runnablePtr));
+        schedule(runnablePtr);
+    }
+
+    /**
+     * Same as addRunnableAndForget, the runnable is not run if token is cancelled before it starts.
+     */
+    template<typename T>
+    void addRunnableAndForget(CancellationToken token, T &&runnable, Args... args) {
+        Record *record = m_runnables.emplaceDetached(
+            std::move(runnable),
+            std::forward<Args>(args)...
+        );
+        record->m_token = std::move(token);
+
+        schedule(record);
+    }
+
+    /**
+     * Same as addRunnableAndForget, the scheduler uses hint to decide when to run it.
+     */
+    template<typename T>
+    void addRunnableAndForget(SchedulingHint hint, T &&runnable, Args... args) {
+        RunnableAndArgs *runnablePtr = m_runnables.emplaceDetached(
+            std::move(runnable),
+            std::forward<Args>(args)...
+        );
+
+        schedule(runnablePtr, hint);
+    }
+
+    /**
+     * Add all the runnables from first to last with the same arguments.
+     *
+     * The storage is reserved once, each queue is locked at most once
+     * and only the needed workers are woken up
+     * @return a handle on each runnable, in the same order
+     */
+    template<typename Iterator>
+    std::vector<TaskHandle<ResultOf<typename std::iterator_traits<Iterator>::value_type>, RunnableType>>
+    addRunnables(Iterator first, Iterator last, Args... args) {
+        using ResultType = ResultOf<typename std::iterator_traits<Iterator>::value_type>;
+        auto runnablePtrs = emplaceRunnables(first, last, false, args...);
+
+        std::vector<TaskHandle<ResultType, RunnableType>> handles;
+        handles.reserve(runnablePtrs.size());
+        for(auto runnablePtr : runnablePtrs) {
+            handles.emplace_back(std::addressof(std::get<0>(*runnablePtr)));
+        }
+
+        scheduleBulk(runnablePtrs);
+        return handles;
+    }
+
+    template<typename Range>
+    auto addRunnables(const Range &runnables, Args... args) {
+        return addRunnables(std::begin(runnables), std::end(runnables), std::forward<Args>(args)...);
+    }
+
+    /**
+     * Add all the runnables from first to last without giving them back
+     */
+    template<typename Iterator>
+    void addRunnablesAndForget(Iterator first, Iterator last, Args... args) {
+        scheduleBulk(emplaceRunnables(first, last, true, args...));
+    }
+
+    template<typename Range>
+    void addRunnablesAndForget(const Range &runnables, Args... args) {
+        addRunnablesAndForget(std::begin(runnables), std::end(runnables), std::forward<Args>(args)...);
+    }
+
+    /**
+     * Same as addRunnable, the runnable is scheduled once time is reached.
+     *
+     * It is pending from now on : wait() waits for it. handle.cancel() keeps it from being run
+     * and gives it to the workers at once, so wait() does not wait for its time
+     */
+    template<typename T>
+    DelayedTaskHandle<ResultOf<T>, RunnableType> addRunnableAt(TimerWheel::clock::time_point time, T &&runnable, Args... args) {
+        Record *record = m_runnables.emplace(
+            std::move(runnable),
+            std::forward<Args>(args)...
+        );
+
+        m_numberOfPendingRunnables.fetch_add(1, std::memory_order_relaxed);
+        auto &wheel = timers();
+        auto id = wheel.addAt(time, [this, record] {
+            if(m_isDroppingTimers.load(std::memory_order_relaxed)) {
+                std::get<0>(*record).cancel();
+            }
+            enqueue(record);
+        });
+
+        return DelayedTaskHandle<ResultOf<T>, RunnableType>{std::addressof(std::get<0>(*record)), wheel, id};
+    }
+
+    /**
+     * Same as addRunnable, the runnable is scheduled once delay is elapsed
+     */
+    template<typename T>
+    DelayedTaskHandle<ResultOf<T>, RunnableType> addRunnableAfter(TimerWheel::clock::duration delay, T &&runnable, Args... args) {
+        return addRunnableAt(TimerWheel::clock::now() + delay, std::forward<T>(runnable), std::forward<Args>(args)...);
+    }
+
+    /**
+     * Schedule a copy of runnable every period, the first one after one period.
+     *
+     * Each copy is added as with addRunnableAndForget. The copies are not pending before they are scheduled :
+     * wait() does not wait for the next one. The timer is dropped by shutdown and by the destructor
+     * @return The identifier of the timer, for cancelTimer
+     */
+    template<typename T>
+    TimerId addPeriodic(TimerWheel::clock::duration period, T &&runnable, Args... args) {
+        return timers().addPeriodic(period, [this, runnable = special_decay_t<T>(std::forward<T>(runnable)), args...]() mutable {
+            addRunnableAndForget(special_decay_t<T>(runnable), args...);
+        });
+    }
+
+    /**
+     * Stop a periodic timer. Once it returns, no copy is scheduled anymore
+     * @return false if the timer was already cancelled
+     */
+    bool cancelTimer(TimerId id) noexcept {
+        return timers().cancel(id);
+    }
+
+    /**
+     * Schedule a node that a worker will resume.
+     *
+     * wait() also waits for the scheduled nodes
+     * @param node - Must live until it is resumed
+     */
+    void scheduleResumable(ResumableNode *node) noexcept {
+        MAN_METRICS_OF(metricsOfCurrentThread());
+        m_numberOfPendingRunnables.fetch_add(1, std::memory_order_relaxed);
+        m_resumables.push(node);
+        m_idleWorkers.notifyOne();
+    }
+
+#if defined(MAN_HAS_COROUTINES)
+    /**
+     * Awaitable that resumes the coroutine on a worker
+     *
+     * co_await pool.schedule();
+     */
+    ScheduleOperation<ThreadPoolWithContextsAndArgs> schedule() noexcept {
+        return ScheduleOperation<ThreadPoolWithContextsAndArgs>{*this};
+    }
+#endif
+
+    /**
+     * The number of workers running now, which changes with the load in an elastic pool
+     */
+    std::size_t getNumberOfThreads() const noexcept {
+        return m_numberOfActiveThreads.load(std::memory_order_relaxed);
+    }
+
+    std::size_t getMaximumNumberOfThreads() const noexcept {
+        return m_threads.size();
+    }
+
+    bool isCurrentThreadAWorker() const noexcept {
+        return currentWorker().m_pool == this;
+    }
+
+    /**
+     * Run one pending runnable on the calling worker, with its contexts, or resume one scheduled coroutine.
+     *
+     * A task that waits for other tasks calls it to help instead of holding its worker
+     * @return false if the calling thread is not a worker of the pool, or if nothing is pending
+     */
+    bool runPendingRunnable() noexcept {
+        auto &worker = currentWorker();
+
+        if(worker.m_pool != this) {
+            return false;
         }
 
-        m_queues[(m_runnables.size() - 1) % m_threadNumber].push(runnablePtr);
+        if(auto runnable = m_scheduler.pop(worker.m_index); runnable != nullptr) {
+            execute(runnable, *worker.m_context);
+            return true;
+        }
 
-        return std::addressof(std::get<0>(*runnablePtr));
+        if(auto injected = takeInjectedRunnables(worker.m_index); injected != nullptr) {
+            execute(injected, *worker.m_context);
+            return true;
+        }
+
+        return resumeScheduled();
+    }
+
+    /**
+     * The issues reported by the tasks through reportIssue, one ring by worker
+     */
+    IssueChannel &getIssueChannel() noexcept {
+        return m_issues;
+    }
+
+#if MAN_ENABLE_METRICS
+    /**
+     * Read the counters of each worker without stopping them.
+     *
+     * The counters of different workers are not read at the same time,
+     * so the snapshot is only coherent once the pool is idle.
+     */
+    MetricsSnapshot snapshot() const {
+        MetricsSnapshot snapshot;
+        snapshot.m_workers.reserve(m_metrics.size());
+
+        for(std::size_t i{0}; i < m_metrics.size(); ++i) {
+            snapshot.m_workers.push_back(takeSnapshot(m_metrics[i], m_scheduler.sizeOf(i)));
+        }
+
+        return snapshot;
     }
+#endif
 
     /**
      * Wait for all runnables to finish
      */
     void wait() noexcept {
-        for(auto &runnable : m_runnables) {
-            std::get<0>(runnable).waitUntilFinished();
+        for(auto pending = m_numberOfPendingRunnables.load(std::memory_order_acquire); pending != 0;
+            pending = m_numberOfPendingRunnables.load(std::memory_order_acquire)) {
+            WaitPolitic::waitWhileEqual(m_numberOfPendingRunnables, pending);
         }
     }
 
     /**
-     * Wait for all runnables to finish and clear the vector of runnable
+     * Wait for all runnables to finish and destroy them
      */
     void clear() noexcept {
         wait();
@@ -79,87 +542,430 @@ public:
         m_runnables.clear();
     }
 
-    ~ThreadPoolWithContextsAndArgs() noexcept {
-        auto areFinished = [](auto &runnable){return std::get<0>(runnable).isFinished();};
-        assert(std::all_of(m_runnables.begin(), m_runnables.end(), areFinished));
+    /**
+     * Stop the workers once every pending runnable is finished.
+     *
+     * With DROP_PENDING, the runnables which are not started yet are cancelled : the workers finish
+     * them without running them, so only the running tasks delay the shutdown.
+     * No runnable may be added afterwards
+     */
+    void shutdown(ShutdownMode mode = ShutdownMode::WAIT_PENDING) noexcept {
+        if(mode == ShutdownMode::DROP_PENDING) {
+            m_isDroppingPending.store(true, std::memory_order_relaxed);
+            dropTimers();
+        }
+
+        wait();
 
-        for(auto &queue : m_queues) {
-            queue.finish();
+        // Only the periodic timers are left, their last copies are waited for
+        if(dropTimers()) {
+            wait();
         }
+        stopWorkers();
+    }
 
-        for(auto &thread : m_threads) {
-            thread.join();
+    /**
+     * The delayed runnables which are still waiting for their time are cancelled
+     */
+    ~ThreadPoolWithContextsAndArgs() noexcept {
+        if(dropTimers()) {
+            wait();
         }
+        assert(m_numberOfPendingRunnables.load(std::memory_order_acquire) == 0 &&
+               "All the runnables must be finished");
+
+        stopWorkers();
     }
 
 private:
 
     /**
      * Function that runs on another thread
-     * @param currentQueue
+     * @param index - The index of the worker within the scheduler
      * @param initializers
      */
     template<typename ...Fs>
-    void run(Queue &currentQueue, Fs&& ...initializers) noexcept {
+    void run(std::size_t index, Fs&& ...initializers) noexcept {
         Context vars{initializers()...};
-        while(!currentQueue.isDone()) {
-            if(auto runnable = getRunnableAndArgs(currentQueue); runnable != nullptr) {
-                auto applyContext = [runnable](auto &...contexts) {
-                    auto applyArgs = [&contexts...](Runnable<Contexts..., Args...> &runnable, auto &&... args) noexcept {
-                        runnable.launch(contexts..., std::forward<decltype(args)>(args)...);
-                    };
-                    std::apply(applyArgs, *runnable);
-                };
-                std::apply(applyContext, vars);
+        std::size_t round{0};
+        std::size_t idleRound{0};
+        std::chrono::steady_clock::time_point idleSince;
+        auto mustNotPark = [this, index] {
+            return m_scheduler.isDone(index) || m_scheduler.hasWork() ||
+                   !m_injectedRunnables.isEmpty() || !m_resumables.isEmpty();
+        };
+
+        currentWorker() = WorkerIdentity{this, index, &vars};
+        m_issues.attachCurrentThread(index);
+#if MAN_ENABLE_METRICS
+        detail::currentWorkerMetrics() = &m_metrics[index];
+#endif
+
+        while(!m_scheduler.isDone(index)) {
+            // The coroutines are not starved by a steady flow of runnables
+            if(++round % resumablePeriod == 0 && resumeScheduled()) {
+                idleRound = 0;
+                onTaskFinishedOf(vars);
+            }
+
+            else if(auto runnable = m_scheduler.pop(index); runnable != nullptr) {
+                idleRound = 0;
+                execute(runnable, vars);
+                onTaskFinishedOf(vars);
+            }
+
+            else if(auto injected = takeInjectedRunnables(index); injected != nullptr) {
+                idleRound = 0;
+                execute(injected, vars);
+                onTaskFinishedOf(vars);
+            }
+
+            else if(resumeScheduled()) {
+                idleRound = 0;
+                onTaskFinishedOf(vars);
+            }
+
+            else if(index >= m_minimumNumberOfThreads) {
+                MAN_METRIC_ADD(m_idleRounds, 1);
+                MAN_METRIC_SCOPE(m_idleTime);
+
+                auto now = std::chrono::steady_clock::now();
+
+                if(idleRound == 0) {
+                    idleSince = now;
+                }
+
+                else if(now - idleSince >= m_idleTimeout && retire(index)) {
+                    return;
+                }
+
+                if(idleRound < spawnedWorkerSpinRounds) {
+                    WaitPolitic::idle(idleRound, m_idleWorkers, [] {return true;});
+                }
+
+                // A spawned worker parks until some work is submitted, or until it may retire.
+                // It retires after the workers spawned after it, so it may have to wait once again
+                else if(auto key = m_idleWorkers.prepareWait(); mustNotPark()) {
+                    m_idleWorkers.cancelWait();
+                }
+
+                else {
+                    m_idleWorkers.commitWaitUntil(key, std::max(idleSince + m_idleTimeout, now + m_idleTimeout / 16));
+                }
+                idleRound++;
             }
 
             else {
-                std::this_thread::yield();
+                MAN_METRIC_ADD(m_idleRounds, 1);
+                MAN_METRIC_SCOPE(m_idleTime);
+                WaitPolitic::idle(idleRound++, m_idleWorkers, mustNotPark);
+            }
+        }
+    }
+
+    template<typename U>
+    using taskFinishedExpression = decltype(onTaskFinished(std::declval<U&>()));
+
+    /**
+     * Call onTaskFinished on each context which has one, like ArenaContext.
+     *
+     * It is not called for the runnables run by runPendingRunnable, their worker is still inside another task
+     */
+    static void onTaskFinishedOf(Context &vars) noexcept {
+        auto notify = [](auto &context) noexcept {
+            if constexpr(is_valid_v<std::decay_t<decltype(context)>, taskFinishedExpression>) {
+                onTaskFinished(context);
+            }
+        };
+
+        std::apply([&notify](auto &...contexts) noexcept {(notify(contexts), ...);}, vars);
+    }
+
+    /**
+     * Stop the worker index if it is the last running one, and move the runnables
+     * of its queue to the injection queue, where the other workers take them
+     * @return true if the worker must stop
+     */
+    bool retire(std::size_t index) noexcept {
+        auto numberOfActiveThreads = index + 1;
+        if(!m_numberOfActiveThreads.compare_exchange_strong(numberOfActiveThreads, index, std::memory_order_acq_rel)) {
+            return false;
+        }
+
+        // Only its own queue is drained, the runnables pushed to it later are stolen by the other workers
+        for(auto count = m_scheduler.sizeOf(index); count > 0; --count) {
+            auto runnable = m_scheduler.popLocal(index);
+
+            if(runnable == nullptr) {
+                break;
             }
+
+            m_injectedRunnables.push(static_cast<Record*>(runnable));
+            m_idleWorkers.notifyOne();
         }
+
+        return true;
     }
 
-    RunnableAndArgs *getRunnableAndArgs(Queue &currentQueue) noexcept {
-        if(auto runnable = tryToPopFromOneQueue(); runnable != nullptr) {
-            return runnable;
+    /**
+     * Spawn a worker if there are too many pending runnables by worker
+     */
+    void growIfNeeded() noexcept {
+        auto numberOfActiveThreads = m_numberOfActiveThreads.load(std::memory_order_relaxed);
+
+        if(numberOfActiveThreads >= m_threads.size() ||
+           m_numberOfPendingRunnables.load(std::memory_order_relaxed) <= numberOfActiveThreads * m_spawnThreshold) {
+            return;
+        }
+
+        // Only one thread spawns at a time, the other submitters do not wait for it
+        std::unique_lock lock{m_threadsMutex, std::try_to_lock};
+
+        if(!lock || numberOfActiveThreads >= m_threads.size() ||
+           !m_numberOfActiveThreads.compare_exchange_strong(numberOfActiveThreads, numberOfActiveThreads + 1,
+                                                            std::memory_order_acq_rel)) {
+            return;
+        }
+
+        // The worker which retired from this slot may still be migrating its queue
+        auto &thread = m_threads[numberOfActiveThreads];
+        if(thread.joinable()) {
+            thread.join();
         }
 
-        return currentQueue.pop();
+        try {
+            thread = m_startWorker(numberOfActiveThreads);
+        } catch(const std::system_error &) {
+            m_numberOfActiveThreads.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    static std::size_t maximumNumberOfThreads(const ThreadPoolOptions &options) noexcept {
+        return std::max(options.m_numberOfThreads, options.m_maximumNumberOfThreads);
+    }
+
+    /**
+     * The timer wheel and its thread are created with the first timer
+     */
+    TimerWheel &timers() {
+        std::call_once(m_timersFlag, [this] {m_timers = std::make_unique<TimerWheel>();});
+        return *m_timers;
     }
 
-    RunnableAndArgs *tryToPopFromOneQueue() noexcept {
-        for(auto &queue : m_queues) {
-            if(auto runnable = queue.pop(std::try_to_lock); runnable != nullptr) {
-                return runnable;
+    /**
+     * Give the delayed runnables to the workers at once, cancelled, drop the periodic timers
+     * and destroy the wheel with its thread
+     * @return false if no timer was ever added
+     */
+    bool dropTimers() noexcept {
+        if(m_timers == nullptr) {
+            return false;
+        }
+
+        m_isDroppingTimers.store(true, std::memory_order_relaxed);
+        m_timers->expireAll();
+        m_timers.reset();
+        return true;
+    }
+
+    void stopWorkers() noexcept {
+        m_scheduler.finish();
+        m_idleWorkers.notifyAll();
+
+        std::scoped_lock lock{m_threadsMutex};
+        for(auto &thread : m_threads) {
+            if(thread.joinable()) {
+                thread.join();
             }
         }
+    }
+
+    void execute(RunnableAndArgs *runnable, Context &vars) noexcept {
+        if(m_isDroppingPending.load(std::memory_order_relaxed) || static_cast<Record*>(runnable)->m_token.isCancelled()) {
+            std::get<0>(*runnable).cancel();
+        }
 
-        return nullptr;
+        MAN_METRIC_ADD(m_executedTasks, 1);
+        MAN_METRIC_SCOPE(m_executionTime);
+        auto applyContext = [runnable](auto &...contexts) {
+            auto applyArgs = [&contexts...](RunnableType &runnable, auto &&... args) noexcept {
+                runnable.launch(contexts..., std::forward<decltype(args)>(args)...);
+            };
+            std::apply(applyArgs, *runnable);
+        };
+        std::apply(applyContext, vars);
+
+        m_runnables.releaseIfDetached(static_cast<Record*>(runnable));
+        onPendingFinished();
     }
 
-    bool tryToPushToOneQueue(RunnableAndArgs *runnablePtr) noexcept {
-        for(auto &queue : m_queues) {
-            if(queue.push(runnablePtr, std::try_to_lock)) {
-                return true;
+    /**
+     * Take a batch of runnables submitted from outside of the pool, keep the first one
+     * and move the other ones into the local queue of the worker
+     */
+    RunnableAndArgs *takeInjectedRunnables(std::size_t index) noexcept {
+        RunnableAndArgs *first = nullptr;
+
+        m_injectedRunnables.tryPopMany(injectionBatchSize, [this, index, &first](Record *record) {
+            if(first == nullptr) {
+                first = record;
+            }
+
+            else {
+                m_scheduler.pushLocal(index, record);
             }
+        });
+
+        return first;
+    }
+
+    /**
+     * Resume one coroutine scheduled on the pool
+     * @return false if none is scheduled
+     */
+    bool resumeScheduled() noexcept {
+        auto node = m_resumables.tryPop();
+
+        if(node == nullptr) {
+            return false;
+        }
+
+        {
+            MAN_METRIC_ADD(m_executedTasks, 1);
+            MAN_METRIC_SCOPE(m_executionTime);
+            node->resume();
+        }
+        onPendingFinished();
+        return true;
+    }
+
+    void onPendingFinished() noexcept {
+        if(m_numberOfPendingRunnables.fetch_sub(1, std::memory_order_release) == 1) {
+            notifyWaiters(m_numberOfPendingRunnables);
+        }
+    }
+
+    template<typename Iterator>
+    std::vector<RunnableAndArgs*> emplaceRunnables(Iterator first, Iterator last, bool isDetached, Args &...args) {
+        std::vector<RunnableAndArgs*> runnablePtrs;
+
+        if constexpr(std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>) {
+            auto count = static_cast<std::size_t>(std::distance(first, last));
+            runnablePtrs.reserve(count);
+            m_runnables.reserve(count);
+        }
+
+        for(; first != last; ++first) {
+            runnablePtrs.emplace_back(isDetached ? m_runnables.emplaceDetached(*first, args...) :
+                                                   m_runnables.emplace(*first, args...));
+        }
+
+        return runnablePtrs;
+    }
+
+    void scheduleBulk(const std::vector<RunnableAndArgs*> &runnablePtrs) noexcept {
+        if(runnablePtrs.empty()) {
+            return;
+        }
+
+        MAN_METRICS_OF(metricsOfCurrentThread());
+        m_numberOfPendingRunnables.fetch_add(runnablePtrs.size(), std::memory_order_relaxed);
+        m_scheduler.pushBulk(runnablePtrs.data(), runnablePtrs.size());
+        m_idleWorkers.notifyMany(runnablePtrs.size());
+        growIfNeeded();
+    }
+
+    template<typename ...Hint>
+    void schedule(RunnableAndArgs *runnablePtr, const Hint &...hint) noexcept {
+        m_numberOfPendingRunnables.fetch_add(1, std::memory_order_relaxed);
+        enqueue(runnablePtr, hint...);
+    }
+
+    /**
+     * Give a runnable already counted as pending to the scheduler
+     */
+    template<typename ...Hint>
+    void enqueue(RunnableAndArgs *runnablePtr, const Hint &...hint) noexcept {
+        static_assert(sizeof...(Hint) == 0 || supports_scheduling_hint_v<Scheduler>,
+                      "The queue politic does not support scheduling hints, use priority_queue_politic");
+        MAN_METRICS_OF(metricsOfCurrentThread());
+
+        if constexpr(supports_scheduling_hint_v<Scheduler>) {
+            // The scheduler orders all the runnables itself
+            m_scheduler.push(runnablePtr, hint...);
         }
 
-        return false;
+        else if(auto &worker = currentWorker(); worker.m_pool == this) {
+            // Nested submission : the runnable stays close to its parent
+            m_scheduler.pushLocal(worker.m_index, runnablePtr);
+        }
+
+        else {
+            m_injectedRunnables.push(static_cast<Record*>(runnablePtr));
+        }
+
+        m_idleWorkers.notifyOne();
+        growIfNeeded();
+    }
+
+#if MAN_ENABLE_METRICS
+    /**
+     * The metrics of the current thread in this pool, nullptr if it is not one of its workers
+     */
+    WorkerMetrics *metricsOfCurrentThread() noexcept {
+        auto &worker = currentWorker();
+        return worker.m_pool == this ? &m_metrics[worker.m_index] : nullptr;
+    }
+#endif
+
+    /**
+     * The worker running on the current thread, if any
+     */
+    static WorkerIdentity &currentWorker() noexcept {
+        static thread_local WorkerIdentity worker{nullptr, 0, nullptr};
+        return worker;
     }
 
 private:
-    const std::size_t m_threadNumber;
     std::vector<std::thread> m_threads;
-    std::vector<RunnableAndArgs> m_runnables;
-    std::vector<Queue> m_queues;
+    RunnableStorage<Record> m_runnables;
+    // Written by every submission and every finished runnable
+    alignas(cacheLineSize) std::atomic<std::size_t> m_numberOfPendingRunnables{0};
+    alignas(cacheLineSize) Scheduler m_scheduler;
+    IssueChannel m_issues;
+    InjectionQueue<Record> m_injectedRunnables;
+    InjectionQueue<ResumableNode> m_resumables;
+    EventCount m_idleWorkers;
+    std::atomic<bool> m_isDroppingPending{false};
+    std::atomic<bool> m_isDroppingTimers{false};
+    std::once_flag m_timersFlag;
+    std::unique_ptr<TimerWheel> m_timers;
+    std::function<std::thread(std::size_t)> m_startWorker;
+    std::mutex m_threadsMutex;
+    // The workers [0, m_numberOfActiveThreads) are running, the last one retires first
+    std::atomic<std::size_t> m_numberOfActiveThreads;
+    std::size_t m_minimumNumberOfThreads;
+    std::size_t m_spawnThreshold;
+    std::chrono::milliseconds m_idleTimeout;
+#if MAN_ENABLE_METRICS
+    std::vector<WorkerMetrics> m_metrics;
+#endif
 };
 
 using ThreadPool = ThreadPoolWithContextsAndArgs<type_list<>, type_list<>>;
 
+using WorkStealingThreadPool = ThreadPoolWithContextsAndArgs<type_list<>, type_list<>, work_stealing_queue_politic>;
+
 template<typename ...Args>
 using ThreadPoolWithArgs = ThreadPoolWithContextsAndArgs<type_list<>, type_list<Args...>>;
 
 template<typename ...Contexts>
 using ThreadPoolWithContext = ThreadPoolWithContextsAndArgs<type_list<Contexts...>, type_list<>>;
 
+template<typename T, typename ...Args>
+using MonomorphicThreadPoolWithArgs = ThreadPoolWithContextsAndArgs<type_list<>, type_list<Args...>, monomorphic_runnable_politic<T>>;
+
+template<typename T>
+using MonomorphicThreadPool = MonomorphicThreadPoolWithArgs<T>;
+
 }
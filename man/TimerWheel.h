@@ -0,0 +1,414 @@
+#pragma once
+#include <deque>
+#include <chrono>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <condition_variable>
+#include "Future.h"
+
+namespace man {
+/**
+ * Identifier of a timer, which stays safe to cancel once the timer is gone
+ */
+struct TimerId {
+    std::uint32_t m_index;
+    std::uint32_t m_generation;
+};
+
+/**
+ * Hierarchical timer wheel driven by its own thread.
+ *
+ * The time is cut into ticks. Each level has 64 slots, a slot of the level L lasts 64^L ticks :
+ * a timer goes into the slot of the lowest level that reaches its expiry, and it moves down one level
+ * each time the lower level wraps around. Adding and cancelling a timer only link and unlink it,
+ * whatever the number of timers. The callbacks are called by the thread of the wheel,
+ * they must be short : they usually give a runnable to a pool.
+ * The time is read from steady_clock, so changing the time of the system does not move the timers.
+ */
+class TimerWheel {
+    static constexpr std::size_t bitsByLevel = 6;
+    static constexpr std::size_t numberOfSlots = std::size_t{1} << bitsByLevel;
+    static constexpr std::size_t numberOfLevels = 5;
+    static constexpr std::uint64_t slotMask = numberOfSlots - 1;
+    // The farthest timers are put in the last level, and moved again until they are close enough
+    static constexpr std::uint64_t maximumDelta = (std::uint64_t{1} << (bitsByLevel * numberOfLevels)) - 1;
+
+    struct Node {
+        Node *m_previous{nullptr};
+        Node *m_next{nullptr};
+        std::uint64_t m_expiry{0};
+        std::uint64_t m_period{0};
+        std::function<void()> m_callback;
+        std::uint32_t m_index{0};
+        std::uint32_t m_generation{0};
+        bool m_isLinked{false};
+    };
+
+    struct Slot {
+        Node m_head;
+
+        Slot() noexcept {
+            m_head.m_previous = m_head.m_next = &m_head;
+        }
+    };
+
+public:
+    using clock = std::chrono::steady_clock;
+
+    /**
+     * @param tick - The resolution of the wheel, a timer fires at most one tick late
+     */
+    explicit TimerWheel(clock::duration tick = std::chrono::milliseconds{1}) :
+        m_tick{tick}, m_origin{clock::now()}, m_thread{[this] {run();}} {}
+
+    TimerWheel(const TimerWheel &) = delete;
+    TimerWheel &operator=(const TimerWheel &) = delete;
+
+    /**
+     * The timers which did not fire are dropped
+     */
+    ~TimerWheel() noexcept {
+        {
+            std::scoped_lock lock{m_mutex};
+            m_isStopping = true;
+        }
+        m_wakeUp.notify_one();
+        m_thread.join();
+    }
+
+    /**
+     * Call callback once time is reached
+     */
+    TimerId addAt(clock::time_point time, std::function<void()> callback) {
+        return add(time, clock::duration{0}, std::move(callback));
+    }
+
+    /**
+     * Call callback every period, the first time after one period
+     */
+    TimerId addPeriodic(clock::duration period, std::function<void()> callback) {
+        return add(clock::now() + period, period, std::move(callback));
+    }
+
+    /**
+     * Stop a timer. Once it returns, its callback is not running, unless it is called by the callback
+     * @return false if the timer already fired or was cancelled
+     */
+    bool cancel(TimerId id) noexcept {
+        std::unique_lock lock{m_mutex};
+        if(id.m_index >= m_nodes.size() || m_nodes[id.m_index].m_generation != id.m_generation) {
+            return false;
+        }
+
+        auto &node = m_nodes[id.m_index];
+        if(&node == m_firingNode) {
+            // A periodic timer is not linked again once its callback returns
+            m_isFiringNodeCancelled = true;
+            auto isPeriodic = node.m_period != 0;
+            if(std::this_thread::get_id() != m_thread.get_id()) {
+                // Once released, the node may fire again for another timer, with another generation
+                m_callbackDone.wait(lock, [this, &node, id] {
+                    return m_firingNode != &node || node.m_generation != id.m_generation;
+                });
+            }
+            return isPeriodic;
+        }
+
+        if(!node.m_isLinked) {
+            return false;
+        }
+
+        unlink(node);
+        release(node);
+        return true;
+    }
+
+    /**
+     * Call now the callback of a timer which is not periodic, instead of at its time.
+     *
+     * The callback is called by the calling thread
+     * @return false if the timer is periodic, already fired or was cancelled
+     */
+    bool expire(TimerId id) {
+        std::function<void()> callback;
+        {
+            std::scoped_lock lock{m_mutex};
+            if(id.m_index >= m_nodes.size() || m_nodes[id.m_index].m_generation != id.m_generation) {
+                return false;
+            }
+
+            auto &node = m_nodes[id.m_index];
+            if(!node.m_isLinked || node.m_period != 0) {
+                return false;
+            }
+
+            unlink(node);
+            callback = std::move(node.m_callback);
+            release(node);
+        }
+
+        callback();
+        return true;
+    }
+
+    /**
+     * Call now the callback of every timer which is not periodic, and drop the periodic ones
+     */
+    void expireAll() {
+        std::vector<std::function<void()>> callbacks;
+        {
+            std::scoped_lock lock{m_mutex};
+            for(auto &node : m_nodes) {
+                if(node.m_isLinked) {
+                    unlink(node);
+                    if(node.m_period == 0) {
+                        callbacks.push_back(std::move(node.m_callback));
+                    }
+                    release(node);
+                }
+            }
+        }
+
+        for(auto &callback : callbacks) {
+            callback();
+        }
+    }
+
+    std::size_t getNumberOfTimers() const noexcept {
+        std::scoped_lock lock{m_mutex};
+        return m_numberOfTimers;
+    }
+
+private:
+    TimerId add(clock::time_point time, clock::duration period, std::function<void()> callback) {
+        TimerId id;
+        {
+            std::scoped_lock lock{m_mutex};
+            if(m_numberOfTimers == 0) {
+                // The thread does not follow the time while the wheel is empty
+                m_currentTick = std::max(m_currentTick, currentTickOf(clock::now()));
+            }
+
+            auto &node = acquire();
+            node.m_expiry = tickOf(time);
+            node.m_period = period > clock::duration{0} ? std::max<std::uint64_t>(1, ticksOf(period)) : 0;
+            node.m_callback = std::move(callback);
+            link(node);
+            id = TimerId{node.m_index, node.m_generation};
+        }
+
+        // The thread may sleep until a later timer
+        m_wakeUp.notify_one();
+        return id;
+    }
+
+    /**
+     * Rounded up, so a timer never fires early
+     */
+    std::uint64_t ticksOf(clock::duration duration) const noexcept {
+        return static_cast<std::uint64_t>((duration + m_tick - clock::duration{1}) / m_tick);
+    }
+
+    /**
+     * The tick of an expiry, rounded up
+     */
+    std::uint64_t tickOf(clock::time_point time) const noexcept {
+        return time <= m_origin ? 0 : ticksOf(time - m_origin);
+    }
+
+    /**
+     * The last tick whose time is reached, rounded down
+     */
+    std::uint64_t currentTickOf(clock::time_point time) const noexcept {
+        return time <= m_origin ? 0 : static_cast<std::uint64_t>((time - m_origin) / m_tick);
+    }
+
+    Node &acquire() {
+        if(m_freeNodes.empty()) {
+            auto &node = m_nodes.emplace_back();
+            node.m_index = static_cast<std::uint32_t>(m_nodes.size() - 1);
+            return node;
+        }
+
+        auto &node = m_nodes[m_freeNodes.back()];
+        m_freeNodes.pop_back();
+        return node;
+    }
+
+    void release(Node &node) noexcept {
+        node.m_callback = nullptr;
+        node.m_generation++;
+        m_freeNodes.push_back(node.m_index);
+    }
+
+    void link(Node &node) noexcept {
+        auto delta = node.m_expiry > m_currentTick ? node.m_expiry - m_currentTick : 0;
+        auto expiry = m_currentTick + std::min(delta, maximumDelta);
+        std::size_t level{0};
+
+        while(level + 1 < numberOfLevels && delta >= (std::uint64_t{1} << (bitsByLevel * (level + 1)))) {
+            ++level;
+        }
+
+        auto &head = m_levels[level][(expiry >> (bitsByLevel * level)) & slotMask].m_head;
+        node.m_previous = head.m_previous;
+        node.m_next = &head;
+        head.m_previous->m_next = &node;
+        head.m_previous = &node;
+        node.m_isLinked = true;
+        m_numberOfTimers++;
+    }
+
+    void unlink(Node &node) noexcept {
+        node.m_previous->m_next = node.m_next;
+        node.m_next->m_previous = node.m_previous;
+        node.m_previous = node.m_next = nullptr;
+        node.m_isLinked = false;
+        m_numberOfTimers--;
+    }
+
+    /**
+     * Move the timers of a slot to the lower levels
+     */
+    void cascade(std::size_t level) noexcept {
+        auto &head = m_levels[level][(m_currentTick >> (bitsByLevel * level)) & slotMask].m_head;
+
+        while(head.m_next != &head) {
+            auto &node = *head.m_next;
+            unlink(node);
+            link(node);
+        }
+    }
+
+    /**
+     * Fire the timers of the current tick, then go to the next one
+     */
+    void processTick(std::unique_lock<std::mutex> &lock) {
+        for(std::size_t level{1}; level < numberOfLevels; ++level) {
+            if(((m_currentTick >> (bitsByLevel * (level - 1))) & slotMask) != 0) {
+                break;
+            }
+            cascade(level);
+        }
+
+        auto &head = m_levels[0][m_currentTick & slotMask].m_head;
+        while(head.m_next != &head) {
+            auto &node = *head.m_next;
+            unlink(node);
+
+            m_firingNode = &node;
+            m_isFiringNodeCancelled = false;
+            lock.unlock();
+            node.m_callback();
+            lock.lock();
+            m_firingNode = nullptr;
+
+            if(node.m_period != 0 && !m_isFiringNodeCancelled) {
+                node.m_expiry = m_currentTick + node.m_period;
+                link(node);
+            }
+
+            else {
+                release(node);
+            }
+
+            m_callbackDone.notify_all();
+        }
+
+        m_currentTick++;
+    }
+
+    /**
+     * The tick at which the thread must wake up : the next timer of the first level, or the next cascade
+     */
+    std::uint64_t nextTick() const noexcept {
+        auto tick = m_currentTick;
+
+        do {
+            if(m_levels[0][tick & slotMask].m_head.m_next != &m_levels[0][tick & slotMask].m_head) {
+                return tick;
+            }
+            ++tick;
+        } while((tick & slotMask) != 0);
+
+        return tick;
+    }
+
+    void run() {
+        std::unique_lock lock{m_mutex};
+
+        while(!m_isStopping) {
+            auto now = currentTickOf(clock::now());
+
+            if(m_numberOfTimers == 0) {
+                // Nothing to fire or to cascade, the wheel jumps to the current tick
+                m_currentTick = std::max(m_currentTick, now);
+                m_wakeUp.wait(lock, [this] {return m_isStopping || m_numberOfTimers != 0;});
+                continue;
+            }
+
+            while(m_currentTick <= now && !m_isStopping) {
+                processTick(lock);
+            }
+
+            auto next = nextTick();
+            m_wakeUp.wait_until(lock, m_origin + m_tick * static_cast<clock::rep>(next), [this, next] {
+                return m_isStopping || nextTick() < next;
+            });
+        }
+    }
+
+private:
+    clock::duration m_tick;
+    clock::time_point m_origin;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    std::condition_variable m_callbackDone;
+    Slot m_levels[numberOfLevels][numberOfSlots];
+    // A deque keeps the nodes in place when it grows
+    std::deque<Node> m_nodes;
+    std::vector<std::uint32_t> m_freeNodes;
+    std::uint64_t m_currentTick{0};
+    std::size_t m_numberOfTimers{0};
+    Node *m_firingNode{nullptr};
+    bool m_isFiringNodeCancelled{false};
+    bool m_isStopping{false};
+    std::thread m_thread;
+};
+
+/**
+ * Handle on a runnable scheduled by a timer of the pool.
+ *
+ * Cancelling it also gives the runnable to the pool at once, so the pool does not wait for its time
+ * to finish it. The timer is not expired through a plain TaskHandle, the runnable is finished at its time then
+ */
+template<typename R, typename RunnableType = Runnable<>>
+class DelayedTaskHandle : public TaskHandle<R, RunnableType> {
+public:
+    DelayedTaskHandle(RunnableType *runnable, TimerWheel &timers, TimerId id) noexcept :
+        TaskHandle<R, RunnableType>{runnable}, m_timers{&timers}, m_id{id} {}
+
+    /**
+     * @return true if the runnable will not be run
+     */
+    bool cancel() noexcept {
+        if(!TaskHandle<R, RunnableType>::cancel()) {
+            return false;
+        }
+
+        // A started runnable is already out of its timer
+        if(!this->getRunnable()->isStarted()) {
+            m_timers->expire(m_id);
+        }
+        return true;
+    }
+
+private:
+    TimerWheel *m_timers;
+    TimerId m_id;
+};
+}
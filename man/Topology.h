@@ -0,0 +1,268 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <thread>
+#include <tuple>
+#include <stdexcept>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace man {
+using CpuSet = std::vector<unsigned>;
+
+/**
+ * distances[a][b] tells how far the worker b is from the worker a
+ */
+using DistanceMatrix = std::vector<std::vector<unsigned>>;
+
+/**
+ * Where a logical cpu is inside the machine
+ */
+struct CpuInfo {
+    unsigned m_cpu;
+    unsigned m_core;
+    unsigned m_cache;
+    unsigned m_node;
+    unsigned m_package;
+};
+
+/**
+ * The cpus of the machine, read from the Linux sysfs.
+ *
+ * On other systems, or if sysfs is not readable, the machine is seen as
+ * one node with one core by hardware thread.
+ */
+class Topology {
+public:
+    enum Distance : unsigned {
+        SAME_CPU,
+        SAME_CORE,
+        SAME_CACHE,
+        SAME_NODE,
+        SAME_PACKAGE,
+        REMOTE
+    };
+
+    /**
+     * The topology of the machine, detected once
+     */
+    static const Topology &current() {
+        static const Topology topology = detect();
+        return topology;
+    }
+
+    Topology() noexcept = default;
+
+    /**
+     * The topology of another machine, made of cpus
+     */
+    explicit Topology(std::vector<CpuInfo> cpus) noexcept : m_cpus{std::move(cpus)} {
+        sortCpus();
+    }
+
+    static Topology detect() {
+        Topology topology;
+
+#if defined(__linux__)
+        for(auto cpu : parseCpuList(readLine("/sys/devices/system/cpu/online"))) {
+            auto path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+            auto package = readNumber(path + "/topology/physical_package_id", 0);
+            auto core = readNumber(path + "/topology/core_id", cpu);
+            auto cache = readNumber(path + "/cache/index3/id", package);
+            // The core and cache ids are only unique within a package
+            topology.m_cpus.push_back(CpuInfo{cpu, package * 65536 + core, package * 65536 + cache, 0, package});
+        }
+
+        for(auto node : parseCpuList(readLine("/sys/devices/system/node/online"))) {
+            auto path = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+
+            for(auto cpu : parseCpuList(readLine(path))) {
+                for(auto &info : topology.m_cpus) {
+                    if(info.m_cpu == cpu) {
+                        info.m_node = node;
+                    }
+                }
+            }
+        }
+#endif
+
+        if(topology.m_cpus.empty()) {
+            auto numberOfCpus = std::max(std::thread::hardware_concurrency(), 1u);
+
+            for(unsigned cpu{0}; cpu < numberOfCpus; ++cpu) {
+                topology.m_cpus.push_back(CpuInfo{cpu, cpu, 0, 0, 0});
+            }
+        }
+
+        topology.sortCpus();
+        return topology;
+    }
+
+    /**
+     * The cpus sorted by node, package, cache and core
+     */
+    const std::vector<CpuInfo> &cpus() const noexcept {
+        return m_cpus;
+    }
+
+    std::size_t numberOfNodes() const noexcept {
+        std::vector<unsigned> nodes;
+        for(auto &cpu : m_cpus) {
+            nodes.push_back(cpu.m_node);
+        }
+        std::sort(nodes.begin(), nodes.end());
+        return static_cast<std::size_t>(std::unique(nodes.begin(), nodes.end()) - nodes.begin());
+    }
+
+    unsigned distance(unsigned cpuA, unsigned cpuB) const noexcept {
+        if(cpuA == cpuB) {
+            return SAME_CPU;
+        }
+
+        auto a = find(cpuA);
+        auto b = find(cpuB);
+
+        if(a == nullptr || b == nullptr) {
+            return REMOTE;
+        }
+
+        if(a->m_core == b->m_core) {
+            return SAME_CORE;
+        }
+
+        if(a->m_cache == b->m_cache) {
+            return SAME_CACHE;
+        }
+
+        if(a->m_node == b->m_node) {
+            return SAME_NODE;
+        }
+
+        return a->m_package == b->m_package ? SAME_PACKAGE : REMOTE;
+    }
+
+    /**
+     * The distances between workers pinned to cpuSets, using the first cpu of each set
+     */
+    DistanceMatrix distances(const std::vector<CpuSet> &cpuSets) const {
+        DistanceMatrix matrix(cpuSets.size(), std::vector<unsigned>(cpuSets.size(), REMOTE));
+
+        for(std::size_t a{0}; a < cpuSets.size(); ++a) {
+            for(std::size_t b{0}; b < cpuSets.size(); ++b) {
+                if(!cpuSets[a].empty() && !cpuSets[b].empty()) {
+                    matrix[a][b] = distance(cpuSets[a].front(), cpuSets[b].front());
+                }
+            }
+        }
+
+        return matrix;
+    }
+
+private:
+    /**
+     * Neighbours are next to each other
+     */
+    void sortCpus() noexcept {
+        std::sort(m_cpus.begin(), m_cpus.end(), [](const CpuInfo &a, const CpuInfo &b) {
+            return std::tie(a.m_node, a.m_package, a.m_cache, a.m_core, a.m_cpu) <
+                   std::tie(b.m_node, b.m_package, b.m_cache, b.m_core, b.m_cpu);
+        });
+    }
+
+    const CpuInfo *find(unsigned cpu) const noexcept {
+        auto it = std::find_if(m_cpus.begin(), m_cpus.end(), [cpu](const CpuInfo &info) {
+            return info.m_cpu == cpu;
+        });
+        return it == m_cpus.end() ? nullptr : &*it;
+    }
+
+    static std::string readLine(const std::string &path) {
+        std::ifstream file{path};
+        std::string line;
+        std::getline(file, line);
+        return line;
+    }
+
+    static unsigned readNumber(const std::string &path, unsigned defaultValue) {
+        auto line = readLine(path);
+
+        try {
+            return line.empty() ? defaultValue : static_cast<unsigned>(std::stoul(line));
+        } catch(const std::exception &) {
+            return defaultValue;
+        }
+    }
+
+    /**
+     * Parse a sysfs list like "0-3,8,10-11"
+     */
+    static std::vector<unsigned> parseCpuList(const std::string &list) {
+        std::vector<unsigned> cpus;
+        std::size_t position{0};
+
+        while(position < list.size()) {
+            auto end = list.find(',', position);
+            auto range = list.substr(position, end == std::string::npos ? std::string::npos : end - position);
+            auto dash = range.find('-');
+
+            try {
+                auto first = static_cast<unsigned>(std::stoul(range.substr(0, dash)));
+                auto last = dash == std::string::npos ? first : static_cast<unsigned>(std::stoul(range.substr(dash + 1)));
+
+                for(auto cpu = first; cpu <= last; ++cpu) {
+                    cpus.push_back(cpu);
+                }
+            } catch(const std::exception &) {
+                return {};
+            }
+
+            if(end == std::string::npos) {
+                break;
+            }
+            position = end + 1;
+        }
+
+        return cpus;
+    }
+
+private:
+    std::vector<CpuInfo> m_cpus;
+};
+
+/**
+ * Pin the calling thread to the cpus of cpuSet
+ * @return false if the thread could not be pinned, for example on a system without affinity
+ */
+inline bool pinCurrentThread(const CpuSet &cpuSet) noexcept {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+
+    for(auto cpu : cpuSet) {
+        if(cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+
+    return !cpuSet.empty() && pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpuSet;
+    return false;
+#endif
+}
+
+/**
+ * @return The cpu running the calling thread, or -1 if it is unknown
+ */
+inline int getCurrentCpu() noexcept {
+#if defined(__linux__)
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+}
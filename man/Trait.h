@@ -25,5 +25,25 @@ struct is_valid<T, expr, std::void_t<expr<T>>> : std::true_type{};
 
 template<typename T, template<typename> typename expr>
 inline constexpr bool is_valid_v = is_valid<T, expr>{};
-}
 
+/**
+ * Select the politic of the category Category among Politics...
+ *
+ * Each politic exposes its category through politic_category.
+ * If no politic of this category is given, Default is selected
+ */
+template<typename Category, typename Default, typename ...Politics>
+struct select_politic {
+    using type = Default;
+};
+
+template<typename Category, typename Default, typename Politic, typename ...Politics>
+struct select_politic<Category, Default, Politic, Politics...> {
+    using type = std::conditional_t<std::is_same_v<typename Politic::politic_category, Category>,
+                                    Politic,
+                                    typename select_politic<Category, Default, Politics...>::type>;
+};
+
+template<typename Category, typename Default, typename ...Politics>
+using select_politic_t = typename select_politic<Category, Default, Politics...>::type;
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include "Model.h"
+#include "RunnableState.h"
+
+namespace man {
+/**
+ * Runnable that can only carry a task of type T, timed as ClockPolitic tells.
+ *
+ * The task is stored directly inside the runnable, without the vptr and the type index
+ * of Model, and all the calls to the task are statically dispatched
+ */
+template<typename ClockPolitic, typename T, typename ...Args>
+class BasicTypedRunnable : public RunnableState<BasicTypedRunnable<ClockPolitic, T, Args...>, ClockPolitic> {
+    // No vptr nor type index : the type of the task is known
+    using ModelType = detail::TaskModel<T, Args...>;
+
+    template<typename _ClockPolitic, typename _T, typename ..._Args>
+    friend std::optional<Progression> getProgression(const BasicTypedRunnable<_ClockPolitic, _T, _Args...> &runnable) noexcept;
+
+    template<typename _ClockPolitic, typename _T, typename ..._Args>
+    friend std::vector<Issue> getIssues(const BasicTypedRunnable<_ClockPolitic, _T, _Args...> &runnable) noexcept;
+
+public:
+    using ReturnType = typename ModelType::_ReturnType;
+
+    BasicTypedRunnable(T t) noexcept :
+        m_model{std::move(t)} {}
+
+    BasicTypedRunnable(BasicTypedRunnable &&runnable) noexcept = default;
+
+    BasicTypedRunnable(const BasicTypedRunnable &) = delete;
+    BasicTypedRunnable &operator=(const BasicTypedRunnable &) = delete;
+    BasicTypedRunnable() noexcept = delete;
+
+    /**
+     * This function executes the function carried by the runnable object
+     */
+    void launch(Args... args) noexcept {
+        if(this->start()) {
+            m_model.launch(std::forward<Args>(args)...);
+        }
+        this->finish();
+    }
+
+    /**
+     * This function executes the function carried by the runnable object
+     */
+    void operator()(Args... args) noexcept {
+        launch(std::forward<Args>(args)...);
+    }
+
+    /**
+     * This function moves the result of the function carried by the runnable out of it
+     *
+     * The type of the result is checked at compile time
+     * This function throws std::runtime_error if the result is not available, or if the runnable was cancelled
+     * @return U - The result of the function
+     * @throw std::runtime_error
+     */
+    template<typename U = ReturnType>
+    U getResult() {
+        return std::move(getResultReference<U>());
+    }
+
+    /**
+     * This function return a reference on the result of the function carried by the runnable
+     *
+     * The type of the result is checked at compile time
+     * This function throws std::runtime_error if the result is not available, or if the runnable was cancelled
+     * @return U& - The result of the function, owned by the runnable
+     * @throw std::runtime_error
+     */
+    template<typename U = ReturnType>
+    U &getResultReference() {
+        static_assert(std::is_same_v<U, ReturnType>, "The return value is not correct");
+
+        if(!this->isFinished() || this->isCancelled()) {
+            throw std::runtime_error{"The result is not available"};
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return *m_model.m_result;
+    }
+
+private:
+    ModelType m_model;
+};
+
+template<typename T, typename ...Args>
+using TypedRunnable = BasicTypedRunnable<default_clock_politic, T, Args...>;
+
+/**
+ * Function to retrieve the progression of the runnable object
+ *
+ * The optional is empty if the task carried by the runnable does not have
+ * a getProgression function
+ * @param runnable
+ * @return The progression of the task
+ */
+template<typename ClockPolitic, typename T, typename ...Args>
+inline std::optional<Progression> getProgression(const BasicTypedRunnable<ClockPolitic, T, Args...> &runnable) noexcept  {
+    if(!runnable.isStarted()) {
+        return 0.0f;
+    }
+
+    if(runnable.isFinished()) {
+        return 1.0f;
+    }
+
+    return runnable.m_model.progression();
+}
+
+/**
+ * Function to retrieve all the issues of the runnable object
+ * @param runnable - The task from which we want to retrieve all the issues
+ * @return All issues.
+ */
+template<typename ClockPolitic, typename T, typename ...Args>
+inline std::vector<Issue> getIssues(const BasicTypedRunnable<ClockPolitic, T, Args...> &runnable) noexcept  {
+    return runnable.m_model.issues();
+}
+
+}
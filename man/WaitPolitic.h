@@ -0,0 +1,340 @@
+#pragma once
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cassert>
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#define MAN_CPU_RELAX() _mm_pause()
+#else
+#define MAN_CPU_RELAX() ((void)0)
+#endif
+
+namespace man {
+struct wait_politic_tag{};
+
+/**
+ * Lets threads park until another thread notifies them.
+ *
+ * A waiter calls prepareWait, checks its condition once again, then calls
+ * either cancelWait if the condition is true, or commitWait otherwise.
+ * A notifier changes the condition, then calls notifyOne or notifyAll.
+ * The notifier does not make any system call if nobody is parked.
+ * A waiter may also give up at a deadline with commitWaitUntil.
+ */
+class EventCount {
+public:
+    using Key = std::uint32_t;
+
+    Key prepareWait() noexcept {
+        m_numberOfWaiters.fetch_add(1, std::memory_order_seq_cst);
+        return m_epoch.load(std::memory_order_seq_cst);
+    }
+
+    void cancelWait() noexcept {
+        m_numberOfWaiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void commitWait(Key key) noexcept {
+#if defined(__cpp_lib_atomic_wait)
+        while(m_epoch.load(std::memory_order_acquire) == key) {
+            m_epoch.wait(key, std::memory_order_acquire);
+        }
+#else
+        std::unique_lock lock{m_mutex};
+        m_conditionVariable.wait(lock, [this, key] {
+            return m_epoch.load(std::memory_order_acquire) != key;
+        });
+#endif
+        m_numberOfWaiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Same as commitWait, but the thread wakes up at deadline if it is not notified before
+     * @return false if the deadline was reached
+     */
+    bool commitWaitUntil(Key key, std::chrono::steady_clock::time_point deadline) noexcept {
+        // std::atomic::wait can not time out, the timed waiters park on the condition variable
+        m_numberOfTimedWaiters.fetch_add(1, std::memory_order_relaxed);
+        // Pairs with notifyTimedWaiters
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool isNotified;
+        {
+            std::unique_lock lock{m_mutex};
+            isNotified = m_conditionVariable.wait_until(lock, deadline, [this, key] {
+                return m_epoch.load(std::memory_order_acquire) != key;
+            });
+        }
+        m_numberOfTimedWaiters.fetch_sub(1, std::memory_order_relaxed);
+        m_numberOfWaiters.fetch_sub(1, std::memory_order_relaxed);
+        return isNotified;
+    }
+
+    void notifyOne() noexcept {
+        if(hasWaiters()) {
+            m_epoch.fetch_add(1, std::memory_order_release);
+#if defined(__cpp_lib_atomic_wait)
+            m_epoch.notify_one();
+            notifyTimedWaiters();
+#else
+            std::scoped_lock lock{m_mutex};
+            m_conditionVariable.notify_one();
+#endif
+        }
+    }
+
+    /**
+     * Wake up at most count parked threads
+     */
+    void notifyMany(std::size_t count) noexcept {
+        if(count == 0 || !hasWaiters()) {
+            return;
+        }
+
+        if(count >= m_numberOfWaiters.load(std::memory_order_relaxed)) {
+            notifyAll();
+            return;
+        }
+
+        m_epoch.fetch_add(1, std::memory_order_release);
+#if defined(__cpp_lib_atomic_wait)
+        for(std::size_t i{0}; i < count; ++i) {
+            m_epoch.notify_one();
+        }
+        notifyTimedWaiters();
+#else
+        std::scoped_lock lock{m_mutex};
+        for(std::size_t i{0}; i < count; ++i) {
+            m_conditionVariable.notify_one();
+        }
+#endif
+    }
+
+    void notifyAll() noexcept {
+        if(hasWaiters()) {
+            m_epoch.fetch_add(1, std::memory_order_release);
+#if defined(__cpp_lib_atomic_wait)
+            m_epoch.notify_all();
+            notifyTimedWaiters();
+#else
+            std::scoped_lock lock{m_mutex};
+            m_conditionVariable.notify_all();
+#endif
+        }
+    }
+
+private:
+    bool hasWaiters() noexcept {
+        // Pairs with prepareWait : either the waiter sees the new condition,
+        // or we see the waiter
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return m_numberOfWaiters.load(std::memory_order_relaxed) != 0;
+    }
+
+    /**
+     * Called once the epoch is changed. The few timed waiters are all woken up,
+     * the ones with nothing to do park again
+     */
+    void notifyTimedWaiters() noexcept {
+        // Pairs with commitWaitUntil : either the waiter sees the new epoch, or we see the waiter
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if(m_numberOfTimedWaiters.load(std::memory_order_relaxed) != 0) {
+            std::scoped_lock lock{m_mutex};
+            m_conditionVariable.notify_all();
+        }
+    }
+
+private:
+    std::atomic<Key> m_epoch{0};
+    std::atomic<std::uint32_t> m_numberOfWaiters{0};
+    std::atomic<std::uint32_t> m_numberOfTimedWaiters{0};
+    std::mutex m_mutex;
+    std::condition_variable m_conditionVariable;
+};
+
+/**
+ * Politic that never parks : the waiting threads call yield until
+ * their condition is true.
+ *
+ * It gives the best latency, but burns one core per waiting thread
+ */
+struct yield_wait_politic {
+    using politic_category = wait_politic_tag;
+
+    /**
+     * Called by an idle worker, round is the number of times it has been called in a row
+     */
+    template<typename Condition>
+    static void idle(std::size_t, EventCount &, Condition &&) noexcept {
+        std::this_thread::yield();
+    }
+
+    /**
+     * Wait until value is different from old
+     */
+    template<typename T>
+    static void waitWhileEqual(const std::atomic<T> &value, T old) noexcept {
+        while(value.load(std::memory_order_acquire) == old) {
+            std::this_thread::yield();
+        }
+    }
+};
+
+/**
+ * Politic that spins Spins times, then yields Yields times, then parks the thread.
+ *
+ * When the standard library does not provide std::atomic::wait, the
+ * waiters of a runnable or of a thread pool never park and keep yielding.
+ * The idle workers park anyway.
+ */
+template<std::size_t Spins = 64, std::size_t Yields = 16>
+struct adaptive_wait_politic {
+    using politic_category = wait_politic_tag;
+
+    /**
+     * Called by an idle worker, round is the number of times it has been called in a row
+     * @param eventCount - The event count notified when some work is submitted
+     * @param condition - Returns true if the worker must not park
+     */
+    template<typename Condition>
+    static void idle(std::size_t round, EventCount &eventCount, Condition &&condition) noexcept {
+        if(round < Spins) {
+            MAN_CPU_RELAX();
+        }
+
+        else if(round < Spins + Yields) {
+            std::this_thread::yield();
+        }
+
+        else {
+            auto key = eventCount.prepareWait();
+
+            if(condition()) {
+                eventCount.cancelWait();
+            }
+
+            else {
+                eventCount.commitWait(key);
+            }
+        }
+    }
+
+    /**
+     * Wait until value is different from old
+     *
+     * The thread that changes value must call notify_all
+     */
+    template<typename T>
+    static void waitWhileEqual(const std::atomic<T> &value, T old) noexcept {
+        for(std::size_t i{0}; i < Spins; ++i) {
+            if(value.load(std::memory_order_acquire) != old) {
+                return;
+            }
+            MAN_CPU_RELAX();
+        }
+
+        for(std::size_t i{0}; i < Yields; ++i) {
+            if(value.load(std::memory_order_acquire) != old) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+
+        while(value.load(std::memory_order_acquire) == old) {
+#if defined(__cpp_lib_atomic_wait)
+            value.wait(old, std::memory_order_acquire);
+#else
+            std::this_thread::yield();
+#endif
+        }
+    }
+};
+
+/**
+ * Politic that parks the waiting threads as soon as possible
+ */
+using park_wait_politic = adaptive_wait_politic<0, 0>;
+
+using default_wait_politic = adaptive_wait_politic<>;
+
+/**
+ * Wake up all the threads waiting on value with waitWhileEqual
+ */
+template<typename T>
+inline void notifyWaiters(std::atomic<T> &value) noexcept {
+#if defined(__cpp_lib_atomic_wait)
+    value.notify_all();
+#else
+    (void)value;
+#endif
+}
+
+/**
+ * Number of unfinished tasks, which the waiting thread may destroy as soon as wait returns.
+ *
+ * The thread finishing the last task wakes up the waiters before it publishes zero, so it never
+ * touches the counter once a waiter may see it finished. Meanwhile the waiters yield.
+ */
+class CompletionCounter {
+    static constexpr std::size_t notifying = ~std::size_t{0};
+
+public:
+    explicit CompletionCounter(std::size_t count = 0) noexcept : m_count{count} {}
+
+    void add(std::size_t count = 1) noexcept {
+        auto current = m_count.load(std::memory_order_relaxed);
+
+        do {
+            // The last finishing thread may still be waking up the waiters
+            while(current == notifying) {
+                std::this_thread::yield();
+                current = m_count.load(std::memory_order_relaxed);
+            }
+        } while(!m_count.compare_exchange_weak(current, current + count, std::memory_order_relaxed));
+    }
+
+    /**
+     * @return true if the last task is finished, the counter must not be used anymore by this thread
+     */
+    bool finish(std::size_t count = 1) noexcept {
+        auto current = m_count.load(std::memory_order_relaxed);
+
+        do {
+            assert(current != notifying && current >= count && "More tasks are finished than added");
+        } while(!m_count.compare_exchange_weak(current, current == count ? notifying : current - count,
+                                               std::memory_order_acq_rel, std::memory_order_relaxed));
+
+        if(current != count) {
+            return false;
+        }
+
+        notifyWaiters(m_count);
+        m_count.store(0, std::memory_order_release);
+        return true;
+    }
+
+    template<typename WaitPolitic = default_wait_politic>
+    void wait() const noexcept {
+        for(auto count = m_count.load(std::memory_order_acquire); count != 0; count = m_count.load(std::memory_order_acquire)) {
+            if(count == notifying) {
+                std::this_thread::yield();
+            }
+
+            else {
+                WaitPolitic::waitWhileEqual(m_count, count);
+            }
+        }
+    }
+
+    bool isFinished() const noexcept {
+        return m_count.load(std::memory_order_acquire) == 0;
+    }
+
+private:
+    std::atomic<std::size_t> m_count;
+};
+}
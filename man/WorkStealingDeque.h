@@ -0,0 +1,162 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cassert>
+#include "CacheLine.h"
+
+namespace man {
+/**
+ * Chase-Lev work stealing deque.
+ *
+ * Only the owner thread may call push and pop, they work on the bottom of
+ * the deque (LIFO). Any other thread may call steal, which takes from the
+ * top of the deque (FIFO).
+ * The memory orders follow "Correct and Efficient Work-Stealing for Weak
+ * Memory Models" (Lê, Pop, Cohen, Zappa Nardelli).
+ */
+template<typename T>
+class WorkStealingDeque {
+    class Array {
+    public:
+        explicit Array(std::int64_t capacity) noexcept :
+            m_capacity{capacity},
+            m_mask{capacity - 1},
+            m_items{std::make_unique<std::atomic<T*>[]>(static_cast<std::size_t>(capacity))} {
+            assert((capacity & m_mask) == 0 && "The capacity must be a power of two");
+        }
+
+        std::int64_t capacity() const noexcept {
+            return m_capacity;
+        }
+
+        T *get(std::int64_t index) const noexcept {
+            return m_items[index & m_mask].load(std::memory_order_relaxed);
+        }
+
+        void put(std::int64_t index, T *item) noexcept {
+            m_items[index & m_mask].store(item, std::memory_order_relaxed);
+        }
+
+        std::unique_ptr<Array> grow(std::int64_t bottom, std::int64_t top) const noexcept {
+            auto array = std::make_unique<Array>(2 * m_capacity);
+            for(auto i = top; i != bottom; ++i) {
+                array->put(i, get(i));
+            }
+            return array;
+        }
+
+    private:
+        const std::int64_t m_capacity;
+        const std::int64_t m_mask;
+        std::unique_ptr<std::atomic<T*>[]> m_items;
+    };
+
+public:
+    explicit WorkStealingDeque(std::int64_t capacity = 256) noexcept {
+        m_arrays.emplace_back(std::make_unique<Array>(capacity));
+        m_array.store(m_arrays.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque &) = delete;
+    WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+    /**
+     * Push an item at the bottom of the deque. Must be called by the owner
+     * @param item
+     */
+    void push(T *item) noexcept {
+        auto bottom = m_bottom.load(std::memory_order_relaxed);
+        auto top = m_top.load(std::memory_order_acquire);
+        auto array = m_array.load(std::memory_order_relaxed);
+
+        if(bottom - top > array->capacity() - 1) {
+            // Thieves may still read the old array, so it is kept alive until destruction
+            m_arrays.emplace_back(array->grow(bottom, top));
+            array = m_arrays.back().get();
+            m_array.store(array, std::memory_order_relaxed);
+        }
+
+        array->put(bottom, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Pop the last pushed item. Must be called by the owner
+     * @return the item or nullptr if the deque is empty
+     */
+    T *pop() noexcept {
+        auto bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        auto array = m_array.load(std::memory_order_relaxed);
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto top = m_top.load(std::memory_order_relaxed);
+
+        if(top > bottom) {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T *item = array->get(bottom);
+
+        if(top == bottom) {
+            // Last item, we race against the thieves
+            if(!m_top.compare_exchange_strong(top, top + 1,
+                                              std::memory_order_seq_cst,
+                                              std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        return item;
+    }
+
+    /**
+     * Steal the first pushed item. Can be called by any thread
+     * @return the item or nullptr if the deque is empty or if the steal failed
+     */
+    T *steal() noexcept {
+        auto top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto bottom = m_bottom.load(std::memory_order_acquire);
+
+        if(top >= bottom) {
+            return nullptr;
+        }
+
+        auto array = m_array.load(std::memory_order_acquire);
+        T *item = array->get(top);
+
+        if(!m_top.compare_exchange_strong(top, top + 1,
+                                          std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return nullptr;
+        }
+
+        return item;
+    }
+
+    /**
+     * The size is only a hint when other threads are working on the deque
+     */
+    std::size_t size() const noexcept {
+        auto bottom = m_bottom.load(std::memory_order_relaxed);
+        auto top = m_top.load(std::memory_order_relaxed);
+        return static_cast<std::size_t>(bottom > top ? bottom - top : 0);
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+private:
+    // The thieves write m_top, only the owner writes m_bottom
+    alignas(cacheLineSize) std::atomic<std::int64_t> m_top{0};
+    alignas(cacheLineSize) std::atomic<std::int64_t> m_bottom{0};
+    std::atomic<Array*> m_array{nullptr};
+    std::vector<std::unique_ptr<Array>> m_arrays;
+};
+}